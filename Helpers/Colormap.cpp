@@ -0,0 +1,149 @@
+/*!
+ @file Colormap.cpp
+ @brief Implementation of Colormap, which colors particles and orbits by one of their attributes in the shaders.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "Colormap.h"
+#include <QtGui/QVector2D>
+#include <algorithm>
+
+#ifdef WIN32
+	#ifdef max
+	#undef max
+	#endif
+
+	#ifdef min
+	#undef min
+	#endif
+#endif
+
+static const int colormapSize = 256;
+
+static const char* colormapGlsl =
+    "uniform sampler2D colormapTexture;\n"
+    "uniform vec2 colormapRange;\n"
+    "uniform float colormapEnabled;\n"
+    "vec4 colormap(float value, vec4 fallback) {\n"     // vertex shader only (uses texture2DLod)
+    "    if (colormapEnabled < 0.5) return fallback;\n"
+    "    float t = clamp((value - colormapRange.x) / (colormapRange.y - colormapRange.x), 0.0, 1.0);\n"
+    "    return vec4(texture2DLod(colormapTexture, vec2((t * 255.0 + 0.5) / 256.0, 0.5), 0.0).rgb, fallback.a);\n"
+    "}\n";
+
+Colormap::Colormap()
+    : initialized(false)
+    , texture(0)
+    , mAttribute(SingleColor)
+    , rangeMin(0.)
+    , rangeMax(1.)
+{}
+
+Colormap::~Colormap()
+{
+    if (texture) glDeleteTextures(1, &texture);
+}
+
+/*! @brief GLSL (without a version line) declaring the colormap uniforms and vec4 colormap(float value, vec4 fallback).
+
+    colormap() returns fallback when coloring by SingleColor, and otherwise the mapped color with fallback's alpha.
+*/
+char const* Colormap::glslSource() { return colormapGlsl; }
+
+/*! @brief The value of an attribute for one sample of a particle.
+*/
+float Colormap::attributeValue(Orbit const& orbit, int particleID, ColorAttribute attribute)
+{
+    switch (attribute) {
+    case Eccentricity: return orbit.e;
+    case SemiMajorAxis: return orbit.axis;
+    case Inclination: return orbit.i;
+    case ParticleID: return particleID;
+    case Time: return orbit.time;
+    default: return 0.f;
+    }
+}
+
+/*! @brief Name of an attribute as shown in the menus.
+*/
+QString Colormap::attributeName(ColorAttribute attribute)
+{
+    switch (attribute) {
+    case Eccentricity: return QString("Eccentricity");
+    case SemiMajorAxis: return QString("Semi-major Axis");
+    case Inclination: return QString("Inclination");
+    case ParticleID: return QString("Particle ID");
+    case Time: return QString("Time");
+    default: return QString("Single Color");
+    }
+}
+
+/*! @brief Builds the color scale texture, interpolating between a few perceptually uniform control colors (dark blue to yellow).
+*/
+void Colormap::initialize()
+{
+    initializeOpenGLFunctions();
+    initialized = true;
+
+    static const GLubyte stops[5][3] = { { 68, 1, 84 }, { 59, 82, 139 }, { 33, 145, 140 }, { 94, 201, 98 }, { 253, 231, 37 } };
+    GLubyte texels[colormapSize][4];
+    for (int k = 0; k < colormapSize; ++k) {
+        double t = 4. * k / (colormapSize - 1);
+        int s = std::min(int(t), 3);
+        double f = t - s;
+        for (int c = 0; c < 3; ++c) texels[k][c] = GLubyte(stops[s][c] + f * (stops[s + 1][c] - stops[s][c]) + 0.5);
+        texels[k][3] = 255;
+    }
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, colormapSize, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+/*! @brief Sets the colormap uniforms of a bound program and binds the color scale to textureUnit.
+*/
+void Colormap::bind(QOpenGLShaderProgram& program)
+{
+    if (!initialized) initialize();
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glActiveTexture(GL_TEXTURE0);
+
+    double max = (rangeMax > rangeMin) ? rangeMax : rangeMin + 1.;
+    program.setUniformValue("colormapTexture", GLint(textureUnit));
+    program.setUniformValue("colormapRange", QVector2D(rangeMin, max));
+    program.setUniformValue("colormapEnabled", GLfloat(mAttribute == SingleColor ? 0. : 1.));
+}
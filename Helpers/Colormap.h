@@ -0,0 +1,84 @@
+/*!
+ @file Colormap.h
+ @brief Class definition for Colormap, which colors particles and orbits by one of their attributes in the shaders.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef COLORMAP_H
+#define COLORMAP_H
+
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLShaderProgram>
+#include <QtGui/QColor>
+#include <QtCore/QString>
+#include "Orbit.h"
+
+/*! @brief The quantity particles and orbits are colored by.  SingleColor keeps the colors chosen in the settings.
+*/
+enum ColorAttribute { SingleColor, Eccentricity, SemiMajorAxis, Inclination, ParticleID, Time, ColorAttributeCount };
+
+/*! @brief Maps a scalar attribute (eccentricity, semi-major axis, ...) to a color on the GPU.
+
+    The renderers upload one float per particle (or per orbit) next to the positions, and their shaders call colormap(), declared by
+    glslSource(), which rescales the value to [0, 1] with the current range and looks it up in a 256 texel texture holding the
+    color scale.  The CPU never computes a color, so switching attribute or range only changes uniforms.
+
+    bind() must be called on a bound program before drawing; it sets the uniforms and binds the texture to textureUnit.
+*/
+class Colormap : protected QOpenGLFunctions
+{
+public:
+    enum { textureUnit = 1 };
+
+    Colormap();
+    ~Colormap();
+    static char const* glslSource();
+    static float attributeValue(Orbit const& orbit, int particleID, ColorAttribute attribute);
+    static QString attributeName(ColorAttribute attribute);
+
+    void setAttribute(ColorAttribute a) { mAttribute = a; }
+    ColorAttribute attribute() const { return mAttribute; }
+    void setRange(double min, double max) { rangeMin = min; rangeMax = max; }
+    double minimum() const { return rangeMin; }
+    double maximum() const { return rangeMax; }
+    void bind(QOpenGLShaderProgram& program);
+
+private:
+    void initialize();
+
+    bool initialized;
+    GLuint texture;
+    ColorAttribute mAttribute;
+    double rangeMin, rangeMax;
+};
+
+#endif
@@ -0,0 +1,290 @@
+/*!
+ @file DensityRenderer.cpp
+ @brief Implementation of DensityRenderer, which draws large particle sets as a tone-mapped screen-space density.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "DensityRenderer.h"
+#include "ParticleRenderer.h"
+#include "GLProfile.h"
+#include <QtCore/QDebug>
+#include <QtGui/QVector4D>
+
+#ifndef GL_RGBA16F
+#define GL_RGBA16F 0x881A
+#endif
+
+#ifndef GL_RGBA32F
+#define GL_RGBA32F 0x8814
+#endif
+
+#ifndef GL_FRAMEBUFFER_BINDING
+#define GL_FRAMEBUFFER_BINDING 0x8CA6
+#endif
+
+static const char* splatVertexMain =
+    "attribute vec4 particle;\n"        // x, y, z, attribute value
+    "uniform mat4 mvp;\n"
+    "uniform vec4 color;\n"
+    "varying vec4 splatColor;\n"
+    "void main() {\n"
+    "    splatColor = colormap(particle.w, color);\n"
+    "    gl_Position = mvp * vec4(particle.xyz, 1.0);\n"
+    "}\n";
+
+static const char* splatFragmentShader =
+    "varying vec4 splatColor;\n"
+    "void main() {\n"
+    "    gl_FragColor = splatColor;\n"
+    "}\n";
+
+static const char* toneMapVertexShader =
+    "attribute vec2 corner;\n"
+    "varying vec2 uv;\n"
+    "void main() {\n"
+    "    uv = 0.5 * corner + 0.5;\n"
+    "    gl_Position = vec4(corner, 0.0, 1.0);\n"
+    "}\n";
+
+static const char* toneMapFragmentShader =
+    "uniform sampler2D density;\n"
+    "uniform float exposure;\n"
+    "varying vec2 uv;\n"
+    "void main() {\n"
+    "    vec4 d = texture2D(density, uv);\n"
+    "    vec3 c = vec3(1.0) - exp(-exposure * d.rgb);\n"
+    "    float a = 1.0 - exp(-exposure * d.a);\n"
+    "    gl_FragColor = vec4(a > 0.0 ? c / a : c, a);\n"   // un-premultiply for the GL_SRC_ALPHA blend
+    "}\n";
+
+DensityRenderer::DensityRenderer()
+    : initialized(false)
+    , valid(false)
+    , points(QOpenGLBuffer::VertexBuffer)
+    , quad(QOpenGLBuffer::VertexBuffer)
+    , density(0)
+    , exposure(0)
+    , exposureCleared(false)
+{}
+
+DensityRenderer::~DensityRenderer()
+{
+    delete density;
+    delete exposure;
+}
+
+/*! @brief Compiles the shaders and creates the buffers.  Called by the first draw().
+*/
+void DensityRenderer::initialize()
+{
+    initializeOpenGLFunctions();
+    initialized = true;
+    valid = splatProgram.addShaderFromSourceCode(QOpenGLShader::Vertex,
+                                                 GLProfile::vertexHeader() + Colormap::glslSource() + splatVertexMain)
+         && splatProgram.addShaderFromSourceCode(QOpenGLShader::Fragment, GLProfile::fragmentHeader() + splatFragmentShader)
+         && splatProgram.link()
+         && toneMapProgram.addShaderFromSourceCode(QOpenGLShader::Vertex, GLProfile::vertexHeader() + toneMapVertexShader)
+         && toneMapProgram.addShaderFromSourceCode(QOpenGLShader::Fragment, GLProfile::fragmentHeader() + toneMapFragmentShader)
+         && toneMapProgram.link();
+    if (!valid) {
+        qWarning() << "DensityRenderer: could not build shaders:" << splatProgram.log() << toneMapProgram.log();
+        return;
+    }
+    points.create();
+    points.setUsagePattern(QOpenGLBuffer::StreamDraw);
+
+    static const GLfloat corners[8] = { -1, -1, 1, -1, -1, 1, 1, 1 };
+    quad.create();
+    quad.bind();
+    quad.allocate(corners, sizeof(corners));
+    quad.release();
+}
+
+/*! @brief Splats the particles and draws their tone-mapped density over the scene.
+*/
+void DensityRenderer::draw(std::vector<GLfloat> const& particles, QMatrix4x4 const& mvp, QSize const& viewport, QColor const& color, Colormap& colormap,
+                           float exposure)
+{
+    if (!initialized) initialize();
+    if (!valid || particles.empty()) return;
+    points.bind();
+    points.allocate(&particles[0], int(particles.size() * sizeof(GLfloat)));
+    points.release();
+    draw(points, int(particles.size() / ParticleRenderer::floatsPerParticle), mvp, viewport, color, colormap, exposure);
+}
+
+/*! @brief Same as above, for count particles already in a buffer (e.g., the one uploaded to a ParticleRenderer).
+*/
+void DensityRenderer::draw(QOpenGLBuffer& particles, int count, QMatrix4x4 const& mvp, QSize const& viewport, QColor const& color,
+                           Colormap& colormap, float exposure)
+{
+    if (!initialized) initialize();
+    if (!valid || count == 0 || viewport.isEmpty()) return;
+
+    if (!density || density->size() != viewport) {
+        delete density;
+        QOpenGLFramebufferObjectFormat format;
+        format.setInternalTextureFormat(GL_RGBA16F);
+        density = new QOpenGLFramebufferObject(viewport, format);
+        if (!density->isValid()) {
+            qWarning() << "DensityRenderer: floating-point framebuffers are not supported";
+            delete density;
+            density = 0;
+            valid = false;
+            return;
+        }
+    }
+
+    // the widget may itself be drawing into a framebuffer object (e.g., while recording), so put back whatever was bound
+    // and the viewport, which may be one of several in the widget
+    GLint previous = 0;
+    GLint view[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+    glGetIntegerv(GL_VIEWPORT, view);
+    glViewport(0, 0, viewport.width(), viewport.height());
+    accumulate(density, true, particles, count, mvp, color, colormap);
+    glBindFramebuffer(GL_FRAMEBUFFER, previous);
+    glViewport(view[0], view[1], view[2], view[3]);
+
+    toneMap(density, exposure);
+}
+
+/*! @brief Adds the particles to the long exposure, which is cleared first if clearExposure() was called or the viewport size changed.
+
+    Unlike draw(), this draws nothing on screen; see drawExposure().
+*/
+void DensityRenderer::expose(std::vector<GLfloat> const& particles, QMatrix4x4 const& mvp, QSize const& viewport, QColor const& color,
+                             Colormap& colormap)
+{
+    if (!initialized) initialize();
+    if (!valid || viewport.isEmpty()) return;
+
+    if (!exposure || exposure->size() != viewport) {
+        delete exposure;
+        QOpenGLFramebufferObjectFormat format;
+        format.setInternalTextureFormat(GL_RGBA32F);   // a half float stops counting past 2048 hits on a pixel
+        exposure = new QOpenGLFramebufferObject(viewport, format);
+        exposureCleared = false;
+        if (!exposure->isValid()) {
+            qWarning() << "DensityRenderer: floating-point framebuffers are not supported";
+            delete exposure;
+            exposure = 0;
+            valid = false;
+            return;
+        }
+    }
+    if (particles.empty() && exposureCleared) return;
+    if (!particles.empty()) {
+        points.bind();
+        points.allocate(&particles[0], int(particles.size() * sizeof(GLfloat)));
+        points.release();
+    }
+
+    GLint previous = 0;
+    GLint view[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+    glGetIntegerv(GL_VIEWPORT, view);
+    glViewport(0, 0, viewport.width(), viewport.height());
+    accumulate(exposure, !exposureCleared, points, int(particles.size() / ParticleRenderer::floatsPerParticle), mvp, color, colormap);
+    exposureCleared = true;
+    glBindFramebuffer(GL_FRAMEBUFFER, previous);
+    glViewport(view[0], view[1], view[2], view[3]);
+}
+
+/*! @brief Blends the tone-mapped long exposure over the scene, if anything was exposed since it was last cleared.
+*/
+void DensityRenderer::drawExposure(float brightness)
+{
+    if (!valid || !exposure || !exposureCleared) return;
+    toneMap(exposure, brightness);
+}
+
+/*! @brief Renders one additive point per particle into target, cleared first if clear is set.
+*/
+void DensityRenderer::accumulate(QOpenGLFramebufferObject* target, bool clear, QOpenGLBuffer& particles, int count,
+                                 QMatrix4x4 const& mvp, QColor const& color, Colormap& colormap)
+{
+    target->bind();
+    if (clear) {
+        GLfloat clearColor[4];
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+        glClearColor(0, 0, 0, 0);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+    }
+    if (count == 0) return;
+
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+
+    splatProgram.bind();
+    splatProgram.setUniformValue("mvp", mvp);
+    splatProgram.setUniformValue("color", QVector4D(color.redF(), color.greenF(), color.blueF(), 1.));
+    colormap.bind(splatProgram);
+    particles.bind();
+    splatProgram.enableAttributeArray("particle");
+    splatProgram.setAttributeBuffer("particle", GL_FLOAT, 0, ParticleRenderer::floatsPerParticle);
+    glDrawArrays(GL_POINTS, 0, GLsizei(count));
+    splatProgram.disableAttributeArray("particle");
+    particles.release();
+    splatProgram.release();
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    if (depthTest) glEnable(GL_DEPTH_TEST);
+}
+
+/*! @brief Blends the tone-mapped density in source over whatever framebuffer is bound.
+*/
+void DensityRenderer::toneMap(QOpenGLFramebufferObject* source, float exposure)
+{
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+
+    toneMapProgram.bind();
+    toneMapProgram.setUniformValue("density", 0);
+    toneMapProgram.setUniformValue("exposure", GLfloat(exposure));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, source->texture());
+    quad.bind();
+    toneMapProgram.enableAttributeArray("corner");
+    toneMapProgram.setAttributeBuffer("corner", GL_FLOAT, 0, 2);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    toneMapProgram.disableAttributeArray("corner");
+    quad.release();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    toneMapProgram.release();
+
+    if (depthTest) glEnable(GL_DEPTH_TEST);
+}
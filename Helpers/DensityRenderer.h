@@ -0,0 +1,96 @@
+/*!
+ @file DensityRenderer.h
+ @brief Class definition for DensityRenderer, which draws large particle sets as a tone-mapped screen-space density.  It is used only by OrbitalAnimator.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef DENSITY_RENDERER_H
+#define DENSITY_RENDERER_H
+
+#include <vector>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLShaderProgram>
+#include <QtGui/QOpenGLBuffer>
+#include <QtGui/QOpenGLFramebufferObject>
+#include <QtGui/QMatrix4x4>
+#include <QtGui/QColor>
+#include <QtCore/QSize>
+#include "Colormap.h"
+
+/*! @brief Level-of-detail rendering for particle counts where individual spheres are wasted effort.
+
+    Every particle is splatted as a single point, with additive blending, into a floating-point framebuffer the size of the
+    viewport, so each pixel ends up holding how many particles fall on it (weighted by their color, see Colormap).  Particles are
+    passed in the same layout as for ParticleRenderer.  A second pass draws a full-screen
+    quad that tone-maps that density with 1 - exp(-exposure * density) and blends the result over the scene.  The cost is one
+    vertex per particle and one pass over the screen, whatever the zoom, and dense regions saturate smoothly instead of turning
+    into noise.
+
+    The framebuffer is created lazily and recreated when the viewport size changes.  All functions must be called with the
+    widget's context current (i.e., from paintGL()).
+
+    expose() splats the same way into a second, 32-bit float framebuffer that is not cleared between calls, so that many frames
+    add up to a long exposure of where the particles have been (see LongExposure); drawExposure() tone-maps it like draw().
+    clearExposure() starts a new exposure.
+*/
+class DensityRenderer : protected QOpenGLFunctions
+{
+public:
+    DensityRenderer();
+    ~DensityRenderer();
+    void draw(std::vector<GLfloat> const& particles, QMatrix4x4 const& mvp, QSize const& viewport, QColor const& color, Colormap& colormap,
+              float exposure);
+    void draw(QOpenGLBuffer& particles, int count, QMatrix4x4 const& mvp, QSize const& viewport, QColor const& color, Colormap& colormap,
+              float exposure);
+    void expose(std::vector<GLfloat> const& particles, QMatrix4x4 const& mvp, QSize const& viewport, QColor const& color,
+                Colormap& colormap);
+    void clearExposure() { exposureCleared = false; }
+    void drawExposure(float exposure);
+
+private:
+    void initialize();
+    void accumulate(QOpenGLFramebufferObject* target, bool clear, QOpenGLBuffer& particles, int count, QMatrix4x4 const& mvp,
+                    QColor const& color, Colormap& colormap);
+    void toneMap(QOpenGLFramebufferObject* source, float exposure);
+
+    bool initialized;
+    bool valid;
+    QOpenGLShaderProgram splatProgram;
+    QOpenGLShaderProgram toneMapProgram;
+    QOpenGLBuffer points;
+    QOpenGLBuffer quad;
+    QOpenGLFramebufferObject* density;
+    QOpenGLFramebufferObject* exposure;
+    bool exposureCleared;
+};
+
+#endif
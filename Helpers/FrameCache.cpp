@@ -0,0 +1,193 @@
+/*!
+ @file FrameCache.cpp
+ @brief Implementation of FrameCache, which keeps recently rendered frames to redraw them without rendering.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "FrameCache.h"
+#include "GLProfile.h"
+#include <QtCore/QDebug>
+#include <algorithm>
+
+#ifdef WIN32
+	#ifdef max
+	#undef max
+	#endif
+
+	#ifdef min
+	#undef min
+	#endif
+#endif
+
+static const char* frameVertexShader =
+    "attribute vec2 corner;\n"
+    "varying vec2 uv;\n"
+    "void main() {\n"
+    "    uv = 0.5 * corner + 0.5;\n"
+    "    gl_Position = vec4(corner, 0.0, 1.0);\n"
+    "}\n";
+
+static const char* frameFragmentShader =
+    "uniform sampler2D frame;\n"
+    "varying vec2 uv;\n"
+    "void main() {\n"
+    "    gl_FragColor = vec4(texture2D(frame, uv).rgb, 1.0);\n"
+    "}\n";
+
+FrameCache::FrameCache()
+    : initialized(false)
+    , valid(false)
+    , budget(0)
+    , used(0)
+    , clock(0)
+    , quad(QOpenGLBuffer::VertexBuffer)
+    , texture(0)
+{}
+
+FrameCache::~FrameCache()
+{
+    if (texture) glDeleteTextures(1, &texture);
+}
+
+/*! @brief Sets how many bytes the kept frames may take, dropping the least recently used ones if they take more.  0 turns the
+    cache off and drops them all.
+*/
+void FrameCache::setBudget(qint64 bytes)
+{
+    budget = std::max(bytes, qint64(0));
+    evict();
+}
+
+/*! @brief Drops every frame.  Needs no context.
+*/
+void FrameCache::clear()
+{
+    entries.clear();
+    used = 0;
+    uploaded.clear();
+}
+
+/*! @brief Compiles the shader, and creates the quad and the texture.  Called by the first draw().
+*/
+void FrameCache::initialize()
+{
+    initializeOpenGLFunctions();
+    initialized = true;
+    valid = program.addShaderFromSourceCode(QOpenGLShader::Vertex, GLProfile::vertexHeader() + frameVertexShader)
+         && program.addShaderFromSourceCode(QOpenGLShader::Fragment, GLProfile::fragmentHeader() + frameFragmentShader)
+         && program.link();
+    if (!valid) {
+        qWarning() << "FrameCache: could not build shaders:" << program.log();
+        return;
+    }
+    static const GLfloat corners[8] = { -1, -1, 1, -1, -1, 1, 1, 1 };
+    quad.create();
+    quad.bind();
+    quad.allocate(corners, sizeof(corners));
+    quad.release();
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+/*! @brief Draws the frame kept under key over the whole viewport, which is size pixels.  Returns false, and draws nothing, if
+    there is no such frame.
+*/
+bool FrameCache::draw(QByteArray const& key, QSize const& size)
+{
+    std::map<QByteArray, Entry>::iterator entry = entries.find(key);
+    if (entry == entries.end() || entry->second.image.size() != size) return false;
+    if (!initialized) initialize();
+    if (!valid) return false;
+    entry->second.lastUse = ++clock;
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (uploaded != key) {
+        // QImage pads its rows to 4 bytes, which is GL_UNPACK_ALIGNMENT's default
+        QImage const& image = entry->second.image;
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.width(), image.height(), 0, GL_RGB, GL_UNSIGNED_BYTE, image.constBits());
+        uploaded = key;
+    }
+
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    program.bind();
+    program.setUniformValue("frame", 0);
+    quad.bind();
+    program.enableAttributeArray("corner");
+    program.setAttributeBuffer("corner", GL_FLOAT, 0, 2);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    program.disableAttributeArray("corner");
+    quad.release();
+    program.release();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if (blend) glEnable(GL_BLEND);
+    if (depthTest) glEnable(GL_DEPTH_TEST);
+    return true;
+}
+
+/*! @brief Reads back the bound framebuffer, which is size pixels, and keeps it under key.
+*/
+void FrameCache::store(QByteArray const& key, QSize const& size)
+{
+    if (!enabled() || size.isEmpty() || contains(key)) return;
+    if (!initialized) initialize();
+    QImage pixels(size, QImage::Format_RGBA8888);
+    glReadPixels(0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, pixels.bits());
+    Entry entry = { pixels.convertToFormat(QImage::Format_RGB888), ++clock };
+    if (entry.image.byteCount() > budget) return;
+    used += entry.image.byteCount();
+    entries[key] = entry;
+    evict();
+}
+
+/*! @brief Drops the least recently used frames until the others fit in the budget.
+*/
+void FrameCache::evict()
+{
+    while (used > budget && !entries.empty()) {
+        std::map<QByteArray, Entry>::iterator oldest = entries.begin();
+        for (std::map<QByteArray, Entry>::iterator e = entries.begin(); e != entries.end(); ++e)
+            if (e->second.lastUse < oldest->second.lastUse) oldest = e;
+        used -= oldest->second.image.byteCount();
+        if (uploaded == oldest->first) uploaded.clear();
+        entries.erase(oldest);
+    }
+}
@@ -0,0 +1,91 @@
+/*!
+ @file FrameCache.h
+ @brief Class definition for FrameCache, which keeps recently rendered frames to redraw them without rendering.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef FRAME_CACHE_H
+#define FRAME_CACHE_H
+
+#include <map>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLShaderProgram>
+#include <QtGui/QOpenGLBuffer>
+#include <QtGui/QImage>
+#include <QtCore/QByteArray>
+#include <QtCore/QSize>
+
+/*! @brief Keeps the frames rendered recently, so that showing one of them again (e.g., scrubbing back and forth along the time
+    slider) is a single textured quad instead of a full render.
+
+    A frame is identified by a key that the caller builds from everything the picture depends on (for OrbitalAnimator, the frame
+    number, the camera, the size and the hash of the settings).  store() reads back the bound framebuffer and keeps it in host
+    memory as 8-bit RGB, a quarter less than the RGBA it is read as; draw() uploads a kept frame to a texture and draws it over the
+    whole viewport.  Once the frames take more than the budget, the least recently used ones are dropped.  A budget of 0 turns the
+    cache off.  clear() must be called whenever the picture changes in a way the keys do not cover (e.g., new data is loaded).
+
+    store() and draw() must be called with the context current (i.e., from paintGL()).
+*/
+class FrameCache : protected QOpenGLFunctions
+{
+public:
+    FrameCache();
+    ~FrameCache();
+    void setBudget(qint64 bytes);
+    bool enabled() const { return budget > 0; }
+    bool contains(QByteArray const& key) const { return entries.count(key) > 0; }
+    bool draw(QByteArray const& key, QSize const& size);
+    void store(QByteArray const& key, QSize const& size);
+    void clear();
+
+private:
+    struct Entry {
+        QImage image;       // bottom row first, as read back
+        quint64 lastUse;
+    };
+
+    void initialize();
+    void evict();
+
+    bool initialized;
+    bool valid;
+    qint64 budget;          // in bytes
+    qint64 used;
+    quint64 clock;          // counts the frames stored and drawn, to date each entry's last use
+    std::map<QByteArray, Entry> entries;
+    QOpenGLShaderProgram program;
+    QOpenGLBuffer quad;
+    GLuint texture;
+    QByteArray uploaded;    // key of the frame in texture
+};
+
+#endif
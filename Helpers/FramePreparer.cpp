@@ -0,0 +1,229 @@
+/*!
+ @file FramePreparer.cpp
+ @brief Implementation of FramePreparer, which builds the vertex data of the next frame on a worker thread.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "FramePreparer.h"
+#include "LineRenderer.h"
+#include "ParticleRenderer.h"
+#include "GlyphRenderer.h"
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+
+#ifdef WIN32
+	#ifdef max
+	#undef max
+	#endif
+
+	#ifdef min
+	#undef min
+	#endif
+#endif
+
+/*! @brief Appends one GlyphRenderer instance: an arrow from position along vector.
+*/
+static void appendGlyph(std::vector<GLfloat>& glyphs, Point3d const& position, Point3d const& vector)
+{
+    glyphs.push_back(position.x);
+    glyphs.push_back(position.y);
+    glyphs.push_back(position.z);
+    glyphs.push_back(vector.x);
+    glyphs.push_back(vector.y);
+    glyphs.push_back(vector.z);
+}
+
+/*! @brief Appends the fan filling a ring around the central body (at a focus of the orbit, and at focus in the ring's coordinates)
+    as triangles.
+*/
+static void appendPlane(std::vector<GLfloat>& vertices, std::vector<GLuint>& indices, std::vector<Point3d> const& ring,
+                        Point3d const& focus)
+{
+    GLuint center = GLuint(vertices.size() / 3);
+    GLuint n = GLuint(ring.size());
+    vertices.push_back(focus.x);
+    vertices.push_back(focus.y);
+    vertices.push_back(focus.z);
+    for (size_t f = 0; f < ring.size(); ++f) {
+        vertices.push_back(ring[f].x);
+        vertices.push_back(ring[f].y);
+        vertices.push_back(ring[f].z);
+    }
+    for (GLuint k = 0; k < n; ++k) {
+        indices.push_back(center);
+        indices.push_back(center + 1 + k);
+        indices.push_back(center + 1 + (k + 1) % n);
+    }
+}
+
+FramePreparer::FramePreparer()
+    : data(0)
+    , frames(0)
+    , front(0)
+    , lastFrame(-1)
+{
+}
+
+FramePreparer::~FramePreparer()
+{
+    wait();
+}
+
+/*! @brief Sets the data the frames are prepared from, and the number of frames in it.  Discards the frames prepared so far.
+*/
+void FramePreparer::setData(OrbitData const* d, int f)
+{
+    invalidate();
+    data = d;
+    frames = f;
+}
+
+/*! @brief Waits for the running job, if any, and discards the prepared frames.  Must be called before the data is modified.
+*/
+void FramePreparer::invalidate()
+{
+    wait();
+    buffers[0] = PreparedFrame();
+    buffers[1] = PreparedFrame();
+    lastFrame = -1;
+}
+
+void FramePreparer::wait()
+{
+    if (pending.isRunning()) pending.waitForFinished();
+}
+
+/*! @brief Returns the data of the given frame, and starts preparing the one expected after it.
+
+    The reference stays valid until the next call to acquire() or invalidate().  The vertices are relative to the position of the
+    particle with ID focus at that frame (see PreparedFrame::origin), or to the central body if focus is -1 or not in the data.
+    If rings is false, the orbit rings are not built, and if planes is false, neither are the orbital planes.  Planes are only
+    built along with rings.  If glyphs is false, the normal and velocity glyphs are not built.
+*/
+PreparedFrame const& FramePreparer::acquire(int frame, ColorAttribute attribute, int focus, bool rings, bool planes, bool glyphs)
+{
+    wait();
+    planes = planes && rings;
+    int back = 1 - front;
+    if (!buffers[front].matches(frame, attribute, focus, rings, planes, glyphs)) {
+        if (buffers[back].matches(frame, attribute, focus, rings, planes, glyphs)) front = back;
+        else prepare(&buffers[front], data, frame, attribute, focus, rings, planes, glyphs);
+        back = 1 - front;
+    }
+
+    int step = (lastFrame >= 0 && frame != lastFrame) ? frame - lastFrame : 1;
+    if (frame != lastFrame) lastFrame = frame;
+    int next = frame + step;
+    if (data && next >= 0 && next < frames && !buffers[back].matches(next, attribute, focus, rings, planes, glyphs)) {
+        pending = QtConcurrent::run(&FramePreparer::prepare, &buffers[back], data, next, attribute, focus, rings, planes, glyphs);
+    }
+    return buffers[front];
+}
+
+/*! @brief Fills out with the vertex data of the given frame.  Runs on a worker thread, so it only reads the data.
+*/
+void FramePreparer::prepare(PreparedFrame* out, OrbitData const* data, int frame, ColorAttribute attribute, int focus, bool rings,
+                            bool planes, bool glyphs)
+{
+    out->frame = frame;
+    out->attribute = attribute;
+    out->focus = focus;
+    out->origin = Point3d(0, 0, 0);
+    out->withRings = rings;
+    out->withPlanes = planes;
+    out->withGlyphs = glyphs;
+    out->maxParticleSize = 0;
+    out->velocityGlyphs = 0;
+    out->maxSpeed = 0;
+    out->particles.clear();
+    out->rings.clear();
+    out->planes.clear();
+    out->planeIndices.clear();
+    out->ringOrbits.clear();
+    out->glyphs.clear();
+    if (!data) return;
+
+    OrbitData::const_iterator followed = data->find(focus);
+    if (followed != data->end() && (size_t)frame < (followed->second).size()) out->origin = (followed->second)[frame].position();
+    Point3d const& origin = out->origin;
+
+    out->particles.reserve(ParticleRenderer::floatsPerParticle * data->size());
+    std::vector<Point3d> ring;
+    for (OrbitData::const_iterator itr = data->begin(); itr != data->end(); itr++) {
+        if ((size_t)frame >= (itr->second).size()) continue;
+        Orbit const& orbit = (itr->second)[frame];
+        float value = Colormap::attributeValue(orbit, itr->first, attribute);
+        Point3d p = orbit.position() - origin;
+        out->particles.push_back(p.x);
+        out->particles.push_back(p.y);
+        out->particles.push_back(p.z);
+        out->particles.push_back(value);
+        out->maxParticleSize = std::max(out->maxParticleSize, orbit.particleSize);
+
+        if (rings && !orbit.orbitCoords.empty()) {
+            PreparedFrame::RingOrbit r;
+            r.normal = orbit.normal();
+            r.periapsis = orbit.periapsis();
+            r.apoapsis = orbit.apoapsis();
+            r.first = out->rings.size();
+            ring.resize(orbit.orbitCoords.size());
+            for (size_t f = 0; f < ring.size(); ++f) ring[f] = orbit.toReferenceFrame(orbit.orbitCoords[f]) - origin;
+            LineRenderer::appendPolyline(out->rings, ring, value, true);
+            r.count = out->rings.size() - r.first;
+            r.planeFirst = out->planeIndices.size();
+            if (planes) appendPlane(out->planes, out->planeIndices, ring, -origin);
+            r.planeCount = out->planeIndices.size() - r.planeFirst;
+            out->ringOrbits.push_back(r);
+        }
+    }
+    if (!glyphs) return;
+
+    // normals first, then velocities, so that each set is one contiguous range of instances
+    out->glyphs.reserve(2 * GlyphRenderer::floatsPerGlyph * out->particles.size() / ParticleRenderer::floatsPerParticle);
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1) out->velocityGlyphs = int(out->glyphs.size() / GlyphRenderer::floatsPerGlyph);
+        for (OrbitData::const_iterator itr = data->begin(); itr != data->end(); itr++) {
+            if ((size_t)frame >= (itr->second).size()) continue;
+            Orbit const& orbit = (itr->second)[frame];
+            Point3d position = orbit.position();
+            if (pass == 0) {
+                double size = orbit.hasOrbEls ? orbit.axis : magnitude(position);
+                appendGlyph(out->glyphs, position - origin, orbit.normal() * (0.25 * size));
+            }
+            else {
+                Point3d velocity = orbit.velocity();
+                out->maxSpeed = std::max(out->maxSpeed, magnitude(velocity));
+                appendGlyph(out->glyphs, position - origin, velocity);
+            }
+        }
+    }
+}
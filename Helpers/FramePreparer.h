@@ -0,0 +1,128 @@
+/*!
+ @file FramePreparer.h
+ @brief Class definition for FramePreparer, which builds the vertex data of the next frame on a worker thread.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef FRAME_PREPARER_H
+#define FRAME_PREPARER_H
+
+#include <vector>
+#include <QtCore/QFuture>
+#include <QtGui/QOpenGLFunctions>
+#include "Orbit.h"
+#include "Colormap.h"
+
+/*! @brief The vertex data of one frame of the simulation, ready to be handed to the renderers.
+
+    Everything here depends only on the frame and the color attribute, not on the view, so it can be built before the frame is
+    drawn.  particles holds ParticleRenderer::floatsPerParticle floats per particle, and rings holds the LineRenderer segments of the
+    full orbits, one orbit after the other.  planes holds the vertices (x, y, z) of the filled orbital planes, each a fan around the
+    central body at the focus, and planeIndices the GL_TRIANGLES indices of those fans (see OrbitalPlaneRenderer).  ringOrbits tells
+    where each orbit starts in both, so that the orbits out of view can be left out.  glyphs holds the GlyphRenderer instances of the
+    orbit normals (a quarter of the orbit's size long) followed, from velocityGlyphs on, by those of the velocities (in the data's
+    units, to be scaled by the caller, with maxSpeed the largest).
+
+    All the vertices are relative to origin, the position of the focus particle (or the central body if there is none): the
+    subtraction is done in double precision before the values are rounded to GLfloat, so that what is near the camera keeps its
+    precision however far it is from the central body.  The view matrix must then leave out the translation to origin.
+*/
+struct PreparedFrame
+{
+    /*! @brief Where the segments of one orbit are in PreparedFrame::rings, and what ViewFrustum::classifyOrbit() needs to know about it.
+    */
+    struct RingOrbit {
+        Point3d normal;
+        double periapsis, apoapsis;
+        size_t first, count;            // in floats of rings
+        size_t planeFirst, planeCount;  // in planeIndices
+    };
+
+    PreparedFrame()
+        : frame(-1), attribute(SingleColor), focus(-1), withRings(false), withPlanes(false), withGlyphs(false), maxParticleSize(0)
+        , velocityGlyphs(0), maxSpeed(0) { }
+    bool matches(int f, ColorAttribute a, int id, bool r, bool p, bool g) const
+    { return frame == f && attribute == a && focus == id && (withRings || !r) && (withPlanes || !p) && (withGlyphs || !g); }
+
+    int frame;
+    ColorAttribute attribute;
+    int focus;          // ID of the particle the vertices are relative to, or -1 for the central body
+    Point3d origin;     // position of that particle at frame, in world coordinates
+    bool withRings;
+    bool withPlanes;
+    bool withGlyphs;
+    double maxParticleSize;
+    std::vector<GLfloat> particles;
+    std::vector<GLfloat> rings;
+    std::vector<GLfloat> planes;
+    std::vector<GLuint> planeIndices;
+    std::vector<RingOrbit> ringOrbits;
+    std::vector<GLfloat> glyphs;
+    int velocityGlyphs;     // index of the first velocity glyph in glyphs
+    double maxSpeed;
+};
+
+/*! @brief Prepares the particle and orbit vertex data of frame N+1 on a worker thread while frame N is drawn.
+
+    Gathering the particle positions and rotating every orbit ring into the reference frame used to happen inside paintGL(), so
+    during playback each frame cost its preparation plus its drawing.  FramePreparer keeps two PreparedFrame buffers: the front one
+    is read by the GL thread, while a job on QThreadPool::globalInstance() fills the back one with the frame expected next (the
+    current frame plus the last step taken).  acquire() swaps the two when the prediction was right, and only prepares the frame
+    itself, on the calling thread, when it was not, e.g. after a jump of the time slider.  Playback is then bounded by the slower of
+    the two stages rather than their sum.
+
+    The worker reads the OrbitData passed to setData() without locking, so the data must not change while a job may be running:
+    call invalidate() before modifying or replacing it.
+*/
+class FramePreparer
+{
+public:
+    FramePreparer();
+    ~FramePreparer();
+    void setData(OrbitData const* data, int frames);
+    void invalidate();
+    PreparedFrame const& acquire(int frame, ColorAttribute attribute, int focus, bool rings, bool planes, bool glyphs);
+
+private:
+    static void prepare(PreparedFrame* out, OrbitData const* data, int frame, ColorAttribute attribute, int focus, bool rings,
+                        bool planes, bool glyphs);
+    void wait();
+
+    OrbitData const* data;
+    int frames;
+    PreparedFrame buffers[2];
+    int front;
+    int lastFrame;
+    QFuture<void> pending;
+};
+
+#endif
@@ -0,0 +1,202 @@
+/*!
+ @file FrameRecorder.cpp
+ @brief Implementation of FrameRecorder, which reads recorded frames back asynchronously and saves them on worker threads.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "FrameRecorder.h"
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QPainter>
+#include <QtGui/QFontMetrics>
+#include <QtCore/QThread>
+#include <QtCore/QDebug>
+#include <algorithm>
+
+#ifdef WIN32
+	#ifdef max
+	#undef max
+	#endif
+
+	#ifdef min
+	#undef min
+	#endif
+#endif
+
+/*! @brief Makes a recorder with ringSize pixel-buffer objects, and at most maxQueued images waiting to be saved.
+
+    A maxQueued of 0 allows two images per worker thread, which is enough to keep every core busy.
+*/
+FrameRecorder::FrameRecorder(int ringSize_, int maxQueued)
+    : ringSize(std::max(1, ringSize_))
+    , recording(false)
+    , pixelBuffers(false)
+    , sink(0)
+    , next(0)
+    , queued(maxQueued > 0 ? maxQueued : 2 * std::max(1, QThread::idealThreadCount()))
+{
+}
+
+/*! @brief Waits for the images still being saved.  The pixel-buffer objects must have been released by finish().
+*/
+FrameRecorder::~FrameRecorder()
+{
+    pool.waitForDone();
+}
+
+/*! @brief Starts a recording of frames of the given size (the part of the framebuffer, from its bottom left corner, to save) into s.
+
+    The sink must outlive the recording, i.e. until finish() returns.  Returns false, and records nothing, if it cannot be opened.
+*/
+bool FrameRecorder::begin(QSize const& size_, QFont const& captionFont, FrameSink* s, double fps)
+{
+    if (recording) finish();
+    if (!s->open(size_, fps)) return false;
+    sink = s;
+    initializeOpenGLFunctions();
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    QSurfaceFormat format = context->format();
+    pixelBuffers = context->isOpenGLES() ? format.majorVersion() >= 3 : format.version() >= qMakePair(2, 1);
+
+    size = size_;
+    font = captionFont;
+    failures = 0;
+    next = 0;
+    slots.assign(pixelBuffers ? ringSize : 0, Slot());
+    for (size_t i = 0; i < slots.size(); ++i) {
+        slots[i].buffer = QOpenGLBuffer(QOpenGLBuffer::PixelPackBuffer);
+        slots[i].buffer.create();
+        slots[i].buffer.setUsagePattern(QOpenGLBuffer::StreamRead);
+        slots[i].buffer.bind();
+        slots[i].buffer.allocate(size.width() * size.height() * 4);
+        slots[i].pending = false;
+    }
+    QOpenGLBuffer::release(QOpenGLBuffer::PixelPackBuffer);
+    recording = true;
+    return true;
+}
+
+/*! @brief Reads the bound framebuffer back as frame number of the recording, with caption written at its top.
+
+    Returns as soon as the transfer is queued; it only waits when the buffer it reads into still holds a frame whose pixels have not
+    arrived, or when maxQueued images are already waiting for a worker.
+*/
+void FrameRecorder::capture(int number, QString const& caption)
+{
+    if (!recording) return;
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    if (!pixelBuffers) {
+        QImage image(size, QImage::Format_RGBA8888_Premultiplied);
+        glReadPixels(0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, image.bits());
+        submit(image, number, caption);
+        return;
+    }
+
+    Slot& slot = slots[next];
+    if (slot.pending) collect(slot);
+    slot.buffer.bind();
+    glReadPixels(0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    slot.buffer.release();
+    slot.number = number;
+    slot.caption = caption;
+    slot.pending = true;
+    next = (next + 1) % slots.size();
+}
+
+/*! @brief Passes on the frames still in the ring, waits for the sink to have every image, closes it and releases the pixel-buffer objects.
+
+    Returns false if any image of the recording could not be saved.
+*/
+bool FrameRecorder::finish()
+{
+    if (!recording) return true;
+    for (size_t i = 0; i < slots.size(); ++i) {
+        Slot& slot = slots[(next + i) % slots.size()];   // oldest first
+        if (slot.pending) collect(slot);
+    }
+    for (size_t i = 0; i < slots.size(); ++i) slots[i].buffer.destroy();
+    slots.clear();
+    pool.waitForDone();
+    if (!sink->close()) failures.ref();
+    sink = 0;
+    recording = false;
+    if (failures.load() > 0) qWarning() << "FrameRecorder:" << failures.load() << "frames could not be saved";
+    return failures.load() == 0;
+}
+
+/*! @brief Maps the buffer of slot, copies its pixels into an image and hands it to the encoders.
+*/
+void FrameRecorder::collect(Slot& slot)
+{
+    QImage image(size, QImage::Format_RGBA8888_Premultiplied);
+    int bytes = size.width() * size.height() * 4;
+    slot.buffer.bind();
+    void const* pixels = QOpenGLContext::currentContext()->isOpenGLES()
+            ? slot.buffer.mapRange(0, bytes, QOpenGLBuffer::RangeRead)
+            : slot.buffer.map(QOpenGLBuffer::ReadOnly);
+    if (pixels) {
+        std::copy(static_cast<uchar const*>(pixels), static_cast<uchar const*>(pixels) + bytes, image.bits());
+        slot.buffer.unmap();
+    }
+    slot.buffer.release();
+    slot.pending = false;
+    if (!pixels) {
+        qWarning() << "FrameRecorder: could not map the pixels of frame" << slot.number;
+        failures.ref();
+        return;
+    }
+    submit(image, slot.number, slot.caption);
+}
+
+/*! @brief Queues image for a worker, waiting first if maxQueued images are already queued.
+*/
+void FrameRecorder::submit(QImage const& image, int number, QString const& caption)
+{
+    queued.acquire();
+    QtConcurrent::run(&pool, &FrameRecorder::encode, this, image, number, caption);
+}
+
+/*! @brief Runs on a worker: turns the image the right way up (OpenGL reads from the bottom row), writes the caption and hands it to the sink.
+*/
+void FrameRecorder::encode(FrameRecorder* recorder, QImage image, int number, QString caption)
+{
+    image = image.mirrored();
+    if (!caption.isEmpty()) {
+        QPainter painter(&image);
+        painter.setFont(recorder->font);
+        painter.setPen(QColor(255, 255, 255, 255));
+        QFontMetrics fm(recorder->font);
+        painter.drawText(QPointF((image.width() - fm.width(caption)) / 2., fm.height() + 5), caption);
+    }
+    if (!recorder->sink->write(number, image)) recorder->failures.ref();
+    recorder->queued.release();
+}
@@ -0,0 +1,100 @@
+/*!
+ @file FrameRecorder.h
+ @brief Class definition for FrameRecorder, which reads recorded frames back asynchronously and saves them on worker threads.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef FRAME_RECORDER_H
+#define FRAME_RECORDER_H
+
+#include <vector>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QSemaphore>
+#include <QtCore/QSize>
+#include <QtCore/QString>
+#include <QtCore/QThreadPool>
+#include <QtGui/QFont>
+#include <QtGui/QImage>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLBuffer>
+#include "FrameSink.h"
+
+/*! @brief Saves the frames of a recording without making the renderer wait for the readback or for the PNG compression.
+
+    capture() only queues a glReadPixels() of the bound framebuffer into one of a ring of pixel-buffer objects and returns; the
+    transfer runs while the next frames are rendered, and the pixels are only mapped when their buffer comes round again, ringSize
+    frames later.  The image is then handed to a pool of worker threads that flip it, write its caption (the time, as the recordings
+    have always had) and pass it to the FrameSink of the recording.  At most maxQueued images wait for a worker: when the encoders fall behind, capture() blocks until
+    one is done, so that a long recording cannot fill the memory.
+
+    Contexts without pixel-buffer objects (OpenGL ES 2) read the pixels synchronously, and still encode on the pool.
+
+    begin(), capture() and finish() must be called with the context current.
+*/
+class FrameRecorder : protected QOpenGLFunctions
+{
+public:
+    FrameRecorder(int ringSize = 3, int maxQueued = 0);
+    ~FrameRecorder();
+    bool begin(QSize const& size, QFont const& captionFont, FrameSink* sink, double fps);
+    void capture(int number, QString const& caption);
+    bool finish();
+    bool active() const { return recording; }
+
+private:
+    /*! @brief One pixel-buffer object of the ring, and the frame whose pixels are on their way into it.
+    */
+    struct Slot {
+        QOpenGLBuffer buffer;
+        int number;
+        QString caption;
+        bool pending;
+    };
+
+    void collect(Slot& slot);
+    void submit(QImage const& image, int number, QString const& caption);
+    static void encode(FrameRecorder* recorder, QImage image, int number, QString caption);
+
+    int ringSize;
+    bool recording;
+    bool pixelBuffers;      // whether the context can read into pixel-buffer objects (OpenGL 2.1 or OpenGL ES 3)
+    QSize size;
+    QFont font;
+    FrameSink* sink;
+    std::vector<Slot> slots;
+    size_t next;            // the slot the next capture() reads into
+    QThreadPool pool;
+    QSemaphore queued;      // one resource per image that may still wait for a worker
+    QAtomicInt failures;
+};
+
+#endif
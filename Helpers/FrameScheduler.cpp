@@ -0,0 +1,89 @@
+/*!
+ @file FrameScheduler.cpp
+ @brief Implementation of FrameScheduler, which coalesces redraw requests into at most one frame per display refresh.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "FrameScheduler.h"
+#include <algorithm>
+#include <cmath>
+
+#ifdef WIN32
+	#ifdef max
+	#undef max
+	#endif
+
+	#ifdef min
+	#undef min
+	#endif
+#endif
+
+FrameScheduler::FrameScheduler(QObject* parent)
+    : QObject(parent)
+    , dirty(false)
+    , interval(16)
+{
+    timer.setSingleShot(true);
+    timer.setTimerType(Qt::PreciseTimer);
+    connect(&timer, SIGNAL(timeout()), this, SLOT(fire()));
+    sinceLastFrame.start();
+}
+
+/*! @brief Sets the refresh rate of the display, which bounds how often render() is emitted.  Defaults to 60 Hz.
+*/
+void FrameScheduler::setRefreshRate(qreal hz)
+{
+    if (hz > 0) interval = std::max(1, int(std::floor(1000. / hz)));
+}
+
+/*! @brief Marks the view as needing a redraw, and schedules one for the end of the current refresh interval if none is scheduled.
+*/
+void FrameScheduler::requestFrame()
+{
+    dirty = true;
+    if (timer.isActive()) return;
+    qint64 wait = interval - sinceLastFrame.elapsed();
+    timer.start(int(std::max<qint64>(0, wait)));
+}
+
+/*! @brief Tells the scheduler that a frame is being drawn, which satisfies all the requests made so far.
+*/
+void FrameScheduler::frameRendered()
+{
+    dirty = false;
+    sinceLastFrame.restart();
+}
+
+void FrameScheduler::fire()
+{
+    if (dirty) emit render();
+}
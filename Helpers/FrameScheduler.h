@@ -0,0 +1,79 @@
+/*!
+ @file FrameScheduler.h
+ @brief Class definition for FrameScheduler, which coalesces redraw requests into at most one frame per display refresh.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+#include <QtCore/QElapsedTimer>
+
+/*! @brief Turns any number of redraw requests into at most one frame per display refresh.
+
+    Interactive changes (settings, sliders, spin boxes, wheel and mouse events, color dialogs) each used to call updateGL(),
+    which redraws synchronously, so a drag that produced several events per refresh interval drew the scene several times
+    for one visible frame and fell behind the input in heavy scenes.  They now call requestFrame(), which only marks the view as
+    dirty and, if no frame is already scheduled, arms a single-shot timer for the rest of the current refresh interval.  When it
+    fires, render() is emitted once, however many requests came in.
+
+    The widget calls frameRendered() at the start of every paint, scheduled or not, so that a synchronous redraw (e.g. while
+    playing back the queue, which still calls updateGL() directly) satisfies the pending requests too.
+*/
+class FrameScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    FrameScheduler(QObject* parent = 0);
+    void setRefreshRate(qreal hz);
+    bool pending() const { return dirty; }
+
+public slots:
+    void requestFrame();
+    void frameRendered();
+
+signals:
+    void render();
+
+private slots:
+    void fire();
+
+private:
+    QTimer timer;
+    QElapsedTimer sinceLastFrame;
+    bool dirty;
+    int interval;   // ms
+};
+
+#endif
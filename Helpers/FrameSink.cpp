@@ -0,0 +1,401 @@
+/*!
+ @file FrameSink.cpp
+ @brief Implementation of the places recorded frames go to: numbered stills, or a movie.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "FrameSink.h"
+#include "RecordingManifest.h"
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QProcess>
+#include <QtCore/QDebug>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+#include <cmath>
+#include <deque>
+
+#ifdef WIN32
+	#ifdef max
+	#undef max
+	#endif
+
+	#ifdef min
+	#undef min
+	#endif
+#endif
+
+/*! @brief An ffmpeg process, and the thread that pipes the frames of a VideoSink to it.
+
+    QProcess may only be used from the thread it lives in, and VideoSink::write() is called on FrameRecorder's workers, so the
+    process is started, fed and waited for by run() alone; write() hands it the frames, in order, and blocks while maxQueued of
+    them wait, so that a slow encoder holds back the recording instead of filling the memory.  QProcess ignores SIGPIPE, so an
+    ffmpeg that exits early makes the writes fail rather than killing the application.
+*/
+class FFmpegPipe : public QThread
+{
+public:
+    FFmpegPipe(QStringList const& args) : arguments(args), state(Starting) { }
+    bool waitForStarted();
+    bool write(QByteArray const& frame);
+    bool finish();
+
+protected:
+    void run();
+
+private:
+    enum { maxQueued = 2 };
+    enum State { Starting, Running, Closing, Failed };
+
+    QStringList arguments;
+    QMutex mutex;                       // guards what follows
+    QWaitCondition changed;
+    std::deque<QByteArray> frames;      // waiting to be written to ffmpeg
+    State state;
+};
+
+/*! @brief Waits for ffmpeg to be started.  Returns false if it could not be.
+*/
+bool FFmpegPipe::waitForStarted()
+{
+    QMutexLocker lock(&mutex);
+    while (state == Starting) changed.wait(&mutex);
+    return state != Failed;
+}
+
+/*! @brief Queues frame to be written to ffmpeg, waiting while maxQueued frames already are.  Returns false once writing failed.
+*/
+bool FFmpegPipe::write(QByteArray const& frame)
+{
+    QMutexLocker lock(&mutex);
+    while (state == Running && int(frames.size()) >= maxQueued) changed.wait(&mutex);
+    if (state != Running) return false;
+    frames.push_back(frame);
+    changed.wakeAll();
+    return true;
+}
+
+/*! @brief Writes the frames still queued, closes ffmpeg's input and waits for it to finish encoding.
+
+    Returns false if ffmpeg could not be started, a frame could not be written, or ffmpeg failed.
+*/
+bool FFmpegPipe::finish()
+{
+    {
+        QMutexLocker lock(&mutex);
+        if (state != Failed) state = Closing;
+        changed.wakeAll();
+    }
+    wait();
+    return state != Failed;
+}
+
+void FFmpegPipe::run()
+{
+    QProcess process;
+    process.setProcessChannelMode(QProcess::ForwardedChannels);
+    process.start(VideoSink::ffmpeg(), arguments, QIODevice::WriteOnly);
+    bool ok = process.waitForStarted(-1);
+    {
+        QMutexLocker lock(&mutex);
+        if (state == Starting) state = ok ? Running : Failed;
+        changed.wakeAll();
+    }
+    while (ok) {
+        QByteArray frame;
+        {
+            QMutexLocker lock(&mutex);
+            while (frames.empty() && state == Running) changed.wait(&mutex);
+            if (frames.empty()) break;
+            frame = frames.front();
+            frames.pop_front();
+            changed.wakeAll();
+        }
+        ok = process.write(frame) == frame.size();
+        while (ok && process.bytesToWrite() > 0) ok = process.waitForBytesWritten(-1);
+    }
+    if (ok) {
+        process.closeWriteChannel();
+        ok = process.waitForFinished(-1) && process.exitStatus() == QProcess::NormalExit && process.exitCode() == 0;
+    }
+    else if (process.state() != QProcess::NotRunning) {
+        process.kill();
+        process.waitForFinished(-1);
+    }
+    if (!ok) qWarning() << "VideoSink: ffmpeg failed:" << process.errorString();
+
+    QMutexLocker lock(&mutex);
+    if (!ok) state = Failed;
+    frames.clear();
+    changed.wakeAll();
+}
+
+ImageSequenceSink::ImageSequenceSink(QString const& d, RecordingManifest* m)
+    : dir(d), manifest(m)
+{
+}
+
+/*! @brief The file frame number is saved in, in dir: orbNNNNN.png, NNNNN being number with leading zeroes.
+*/
+QString ImageSequenceSink::fileName(QDir const& dir, int number)
+{
+    // these arguments mean that there should be 5 digits, in base 10, and that the filler characters should be zeroes
+    return dir.absoluteFilePath(QString("orb%1.png").arg(number, 5, 10, QChar('0')));
+}
+
+/*! @brief Checks that the directory is there.
+*/
+bool ImageSequenceSink::open(QSize const&, double)
+{
+    if (!dir.exists()) {
+        qWarning() << "ImageSequenceSink: folder" << dir.path() << "does not exist";
+        return false;
+    }
+    return true;
+}
+
+/*! @brief Saves image in fileName(dir, number).
+*/
+bool ImageSequenceSink::write(int number, QImage const& image)
+{
+    if (!image.save(fileName(dir, number))) return false;
+    if (manifest) manifest->markDone(number);
+    return true;
+}
+
+VideoSink::VideoSink(QString const& p, int first)
+    : path(p)
+    , format(formatOf(p))
+    , firstNumber(first)
+    , file(0)
+    , pipe(0)
+    , failed(false)
+    , nextNumber(0)
+{
+}
+
+VideoSink::~VideoSink()
+{
+    close();
+}
+
+/*! @brief Whether path names a movie rather than a folder for stills: i.e., whether it has one of the suffixes of movie files.
+*/
+bool VideoSink::handles(QString const& path)
+{
+    static const char* suffixes[] = { "y4m", "rgb", "raw", "mp4", "mkv", "mov", "avi", "webm", 0 };
+    QString suffix = QFileInfo(path).suffix().toLower();
+    for (int i = 0; suffixes[i]; ++i)
+        if (suffix == suffixes[i]) return true;
+    return false;
+}
+
+/*! @brief The format of the movie path, from its suffix.
+*/
+VideoSink::Format VideoSink::formatOf(QString const& path)
+{
+    QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == "y4m") return Y4M;
+    if (suffix == "rgb" || suffix == "raw") return RawRGB;
+    return FFmpeg;
+}
+
+/*! @brief The ffmpeg executable: $OGRE_FFMPEG if set, ffmpeg on the path otherwise.
+*/
+QString VideoSink::ffmpeg()
+{
+    return qgetenv("OGRE_FFMPEG").isEmpty() ? QString("ffmpeg") : QString::fromLocal8Bit(qgetenv("OGRE_FFMPEG"));
+}
+
+/*! @brief Joins the movies parts, in that order, into the movie path of the same format.  The parts are left in place.
+
+    Y4M parts are appended without their headers and raw ones as they are; other formats are joined by ffmpeg's concat demuxer,
+    which copies the encoded streams without encoding them again.  Returns false if the movie could not be written.
+*/
+bool VideoSink::concatenate(QStringList const& parts, QString const& path)
+{
+    Format format = formatOf(path);
+    if (format == FFmpeg) {
+        QFile list(path + ".parts.txt");
+        if (!list.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return false;
+        for (int i = 0; i < parts.size(); ++i)
+            list.write(QString("file '%1'\n").arg(QFileInfo(parts[i]).absoluteFilePath().replace("'", "'\\''")).toUtf8());
+        list.close();
+        int status = QProcess::execute(ffmpeg(), QStringList() << "-y" << "-loglevel" << "error" << "-f" << "concat" << "-safe" << "0"
+                                       << "-i" << list.fileName() << "-c" << "copy" << path);
+        list.remove();
+        return status == 0;
+    }
+
+    QFile out(path);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    for (int i = 0; i < parts.size(); ++i) {
+        QFile in(parts[i]);
+        if (!in.open(QIODevice::ReadOnly)) return false;
+        if (format == Y4M && i > 0) in.readLine();     // the header, which the first part already wrote
+        while (!in.atEnd()) {
+            QByteArray chunk = in.read(1 << 20);
+            if (chunk.isEmpty() || out.write(chunk) != chunk.size()) return false;
+        }
+    }
+    return true;
+}
+
+/*! @brief Creates the file (or starts ffmpeg) for frames of the given size, to be played at fps frames per second.
+*/
+bool VideoSink::open(QSize const& s, double fps)
+{
+    close();
+    size = s;
+    nextNumber = firstNumber;
+    failed = false;
+    if (format == FFmpeg) {
+        QStringList args;
+        args << "-y" << "-loglevel" << "error" << "-f" << "rawvideo" << "-pix_fmt" << "rgb24"
+             << "-s" << QString("%1x%2").arg(size.width()).arg(size.height()) << "-r" << QString::number(fps) << "-i" << "-"
+             << "-c:v" << "libx264" << "-pix_fmt" << "yuv420p" << QDir::toNativeSeparators(path);
+        pipe = new FFmpegPipe(args);
+        pipe->start();
+        if (!pipe->waitForStarted()) {
+            qWarning() << "VideoSink: could not start" << ffmpeg() << "to write" << path;
+            pipe->finish();
+            delete pipe;
+            pipe = 0;
+            return false;
+        }
+        return true;
+    }
+    file = fopen(QFile::encodeName(path).constData(), "wb");
+    if (!file) {
+        qWarning() << "VideoSink: could not open" << path;
+        return false;
+    }
+    if (format == Y4M) {
+        // 4:2:0 needs even dimensions, which FrameRecorder's frames have; fps as a fraction with three decimals
+        fprintf(file, "YUV4MPEG2 W%d H%d F%d:1000 Ip A1:1 C420jpeg\n", size.width(), size.height(), int(std::floor(fps * 1000 + 0.5)));
+        planes.resize(size.width() * size.height() * 3 / 2);
+    }
+    return true;
+}
+
+/*! @brief Takes frame number, writing it right away if it is the next one and keeping it until it is otherwise.
+
+    Returns false once writing has failed (e.g., the disk is full or ffmpeg stopped).
+*/
+bool VideoSink::write(int number, QImage const& image)
+{
+    QMutexLocker lock(&mutex);
+    if ((!file && !pipe) || failed) return false;
+    if (number != nextNumber) {
+        waiting[number] = image;
+        return true;
+    }
+    failed = !writeFrame(image);
+    for (++nextNumber; !failed && !waiting.empty() && waiting.begin()->first == nextNumber; ++nextNumber) {
+        failed = !writeFrame(waiting.begin()->second);
+        waiting.erase(waiting.begin());
+    }
+    return !failed;
+}
+
+/*! @brief Writes one frame in the file's format.  Called with mutex locked.
+*/
+bool VideoSink::writeFrame(QImage const& frame)
+{
+    QImage image = frame.convertToFormat(QImage::Format_RGB888);   // premultiplied alpha over black, which is the background
+    int w = size.width(), h = size.height();
+    if (image.size() != size) return false;
+
+    if (pipe) {
+        QByteArray pixels;
+        pixels.reserve(3 * w * h);
+        for (int y = 0; y < h; ++y) pixels.append(reinterpret_cast<char const*>(image.constScanLine(y)), 3 * w);
+        return pipe->write(pixels);
+    }
+    if (format == RawRGB) {
+        for (int y = 0; y < h; ++y)
+            if (fwrite(image.constScanLine(y), 3, w, file) != size_t(w)) return false;
+        return true;
+    }
+
+    // BT.601 studio range, chroma averaged over each 2x2 block of pixels
+    unsigned char* Y = &planes[0];
+    unsigned char* Cb = Y + w * h;
+    unsigned char* Cr = Cb + (w / 2) * (h / 2);
+    for (int y = 0; y < h; y += 2) {
+        uchar const* rows[2] = { image.constScanLine(y), image.constScanLine(y + 1) };
+        for (int x = 0; x < w; x += 2) {
+            int r = 0, g = 0, b = 0;
+            for (int dy = 0; dy < 2; ++dy)
+                for (int dx = 0; dx < 2; ++dx) {
+                    uchar const* p = rows[dy] + 3 * (x + dx);
+                    Y[(y + dy) * w + x + dx] = (unsigned char)((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) / 256 + 16);
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                }
+            int c = (y / 2) * (w / 2) + x / 2;
+            Cb[c] = (unsigned char)((-38 * r - 74 * g + 112 * b + 512) / 1024 + 128);
+            Cr[c] = (unsigned char)((112 * r - 94 * g - 18 * b + 512) / 1024 + 128);
+        }
+    }
+    return fputs("FRAME\n", file) >= 0 && fwrite(&planes[0], 1, planes.size(), file) == planes.size();
+}
+
+/*! @brief Finishes the movie: closes the file, or waits for ffmpeg to encode what it was sent.
+
+    Returns false if a frame was never received or could not be written, or ffmpeg failed.
+*/
+bool VideoSink::close()
+{
+    if (!file && !pipe) return !failed;
+    if (!waiting.empty()) {
+        qWarning() << "VideoSink: frame" << nextNumber << "never arrived;" << waiting.size() << "later frames were dropped";
+        waiting.clear();
+        failed = true;
+    }
+    bool closed;
+    if (pipe) {
+        closed = pipe->finish();
+        delete pipe;
+        pipe = 0;
+    }
+    else {
+        closed = fclose(file) == 0;
+        file = 0;
+    }
+    if (!closed) {
+        qWarning() << "VideoSink: writing" << path << (format == FFmpeg ? "through ffmpeg" : "") << "failed";
+        failed = true;
+    }
+    return !failed;
+}
@@ -0,0 +1,128 @@
+/*!
+ @file FrameSink.h
+ @brief Class definitions for FrameSink and the places recorded frames go to: numbered stills, or a movie.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef FRAME_SINK_H
+#define FRAME_SINK_H
+
+#include <map>
+#include <vector>
+#include <cstdio>
+#include <QtCore/QDir>
+#include <QtCore/QMutex>
+#include <QtCore/QSize>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtGui/QImage>
+
+class RecordingManifest;
+class FFmpegPipe;
+
+/*! @brief Where FrameRecorder sends the frames of a recording.
+
+    open() and close() are called on the thread that renders; write() on FrameRecorder's workers, several at a time and not
+    necessarily in the order of the frames.  A sink that needs the frames in order has to put them back in order itself.
+*/
+class FrameSink
+{
+public:
+    virtual ~FrameSink() { }
+    virtual bool open(QSize const& size, double fps) = 0;
+    virtual bool write(int number, QImage const& image) = 0;
+    virtual bool close() = 0;
+};
+
+/*! @brief Saves every frame as dir/orbNNNNN.png, as recordings always have.
+
+    Five digits, so that ffmpeg's orb%05d.png pattern reads them in order; later frames simply get more digits.  If given a
+    RecordingManifest, marks each frame done in it once saved.
+*/
+class ImageSequenceSink : public FrameSink
+{
+public:
+    ImageSequenceSink(QString const& dir, RecordingManifest* manifest = 0);
+    bool open(QSize const& size, double fps);
+    bool write(int number, QImage const& image);
+    bool close() { return true; }
+    static QString fileName(QDir const& dir, int number);
+
+private:
+    QDir dir;
+    RecordingManifest* manifest;
+};
+
+/*! @brief Writes the frames, in order, to a single movie file: no stills are written, and there is no limit on the number of frames.
+
+    The format follows from the file's suffix:
+    - .y4m, YUV4MPEG2 in 4:2:0 (BT.601, limited range), which ffmpeg, x264 and most players read directly;
+    - .rgb or .raw, bare 8-bit RGB frames one after the other (ffmpeg -f rawvideo -pix_fmt rgb24 -s WxH);
+    - anything else (.mp4, .mkv, ...), encoded with H.264 by an ffmpeg process the frames are piped to.  The executable is
+      $OGRE_FFMPEG if set, ffmpeg on the path otherwise; it is started without a shell, so the path may hold any character,
+      and a missing or failing ffmpeg makes open() or write() return false.
+
+    Frames that arrive before the ones they follow wait in memory; FrameRecorder's bounded queue bounds how many that can be.
+    A movie may start at any frame number, so that the parts of a recording made separately can be joined with concatenate().
+*/
+class VideoSink : public FrameSink
+{
+public:
+    enum Format { Y4M, RawRGB, FFmpeg };
+
+    VideoSink(QString const& path, int firstNumber = 0);
+    ~VideoSink();
+    static bool handles(QString const& path);
+    static Format formatOf(QString const& path);
+    static QString ffmpeg();
+    static bool concatenate(QStringList const& parts, QString const& path);
+    bool open(QSize const& size, double fps);
+    bool write(int number, QImage const& image);
+    bool close();
+
+private:
+    bool writeFrame(QImage const& image);
+
+    QString path;
+    Format format;
+    int firstNumber;                    // number of the movie's first frame
+    QSize size;
+    FILE* file;                         // for Y4M and RawRGB
+    FFmpegPipe* pipe;                   // for FFmpeg
+    bool failed;
+    QMutex mutex;                       // guards what follows, file and pipe
+    int nextNumber;                     // the frame to write next
+    std::map<int, QImage> waiting;      // frames that arrived before nextNumber
+    std::vector<unsigned char> planes;  // Y, Cb and Cr of the Y4M frame being written
+};
+
+#endif
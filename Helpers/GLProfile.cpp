@@ -0,0 +1,89 @@
+/*!
+ @file GLProfile.cpp
+ @brief Implementation of GLProfile, which adapts the renderers to a legacy or a core-profile OpenGL context.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "GLProfile.h"
+#include <QtGui/QOpenGLContext>
+
+static const char* legacyHeader =
+    "#version 120\n";
+
+static const char* coreVertexHeader =
+    "#version 150\n"
+    "#define attribute in\n"
+    "#define varying out\n"
+    "#define texture2D texture\n"
+    "#define texture2DLod textureLod\n";
+
+static const char* coreFragmentHeader =
+    "#version 150\n"
+    "#define varying in\n"
+    "#define texture2D texture\n"
+    "out vec4 fragData[2];\n"          // consecutive locations, for the shaders writing two draw buffers
+    "#define gl_FragColor fragData[0]\n"
+    "#define gl_FragData fragData\n";
+
+/*! @brief Whether the current context is a core-profile one.  Must be called with a context current.
+*/
+bool GLProfile::core()
+{
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    return context && context->format().profile() == QSurfaceFormat::CoreProfile;
+}
+
+/*! @brief The format requested for the whole application by a core_profile build: OpenGL 3.2 core with depth and stencil buffers.
+*/
+QSurfaceFormat GLProfile::coreFormat()
+{
+    QSurfaceFormat format;
+    format.setVersion(3, 2);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    format.setDepthBufferSize(24);
+    format.setStencilBufferSize(8);
+    return format;
+}
+
+/*! @brief The lines to put in front of the GLSL 1.20 source of a vertex shader.
+*/
+QByteArray GLProfile::vertexHeader()
+{
+    return QByteArray(core() ? coreVertexHeader : legacyHeader);
+}
+
+/*! @brief The lines to put in front of the GLSL 1.20 source of a fragment shader.
+*/
+QByteArray GLProfile::fragmentHeader()
+{
+    return QByteArray(core() ? coreFragmentHeader : legacyHeader);
+}
@@ -0,0 +1,66 @@
+/*!
+ @file GLProfile.h
+ @brief Class definition for GLProfile, which adapts the renderers to a legacy or a core-profile OpenGL context.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef GL_PROFILE_H
+#define GL_PROFILE_H
+
+#include <QtCore/QByteArray>
+#include <QtGui/QSurfaceFormat>
+
+/*! @brief What the renderers need to know about the kind of OpenGL context they draw in.
+
+    The renderers in Helpers (LineRenderer, ParticleRenderer, ParticleTrails, DensityRenderer, TextRenderer, ...) only use
+    buffers, shader programs and explicit matrix uniforms, so they work the same in a legacy (2.1 or compatibility) context,
+    where OrbitalAnimator is a QGLWidget, and in a 3.2 core-profile context, where it is a QOpenGLWidget (built with
+    CONFIG += core_profile, see OrbitVisualizer.pro).  The differences are confined here:
+
+    - the shaders are written in GLSL 1.20, and vertexHeader() and fragmentHeader() prepend the version line and, in a core
+      context, the defines that turn that into valid GLSL 1.50 (attribute and varying into in and out, gl_FragColor into an
+      output, gl_FragData into an array of two outputs, texture2D into texture);
+    - core() tells the few callers that enable legacy-only state, or still draw with the fixed-function pipeline, to skip it.
+
+    If a core-profile context could not be created, Qt falls back to a legacy one and core() returns false, so the legacy
+    path is always the fallback.
+*/
+class GLProfile
+{
+public:
+    static bool core();
+    static QSurfaceFormat coreFormat();
+    static QByteArray vertexHeader();
+    static QByteArray fragmentHeader();
+};
+
+#endif
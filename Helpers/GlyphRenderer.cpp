@@ -0,0 +1,219 @@
+/*!
+ @file GlyphRenderer.cpp
+ @brief Draws arrows at many points from one cached arrow mesh, with instancing
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "GlyphRenderer.h"
+#include "GLProfile.h"
+#include <QtGui/QOpenGLContext>
+#include <QtCore/QDebug>
+#include <cmath>
+
+#ifdef WIN32
+	#ifdef max
+	#undef max
+	#endif
+
+	#ifdef min
+	#undef min
+	#endif
+#endif
+
+static const int arrowSides = 12;
+
+// The mesh vertices are (x, y, z, shade), with the arrow along +z from 0 to 1; shade darkens one side so that the arrow looks round
+static const char* glyphVertexShader =
+    "attribute vec4 vertex;\n"
+    "attribute vec3 start;\n"
+    "attribute vec3 direction;\n"
+    "uniform mat4 mvp;\n"
+    "uniform float scale;\n"
+    "varying float shade;\n"
+    "void main() {\n"
+    "    vec3 v = direction * scale;\n"
+    "    float len = length(v);\n"
+    "    vec3 axis = len > 0.0 ? v / len : vec3(0.0, 0.0, 1.0);\n"
+    "    vec3 helper = abs(axis.z) < 0.9 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);\n"
+    "    vec3 side = normalize(cross(helper, axis));\n"
+    "    vec3 up = cross(axis, side);\n"
+    "    shade = vertex.w;\n"
+    "    gl_Position = mvp * vec4(start + (vertex.x * side + vertex.y * up + vertex.z * axis) * len, 1.0);\n"
+    "}\n";
+
+static const char* glyphFragmentShader =
+    "uniform vec4 color;\n"
+    "varying float shade;\n"
+    "void main() {\n"
+    "    gl_FragColor = vec4(color.rgb * shade, color.a);\n"
+    "}\n";
+
+GlyphRenderer::GlyphRenderer()
+    : initialized(false)
+    , valid(false)
+    , instanced(false)
+    , arrowVertices(QOpenGLBuffer::VertexBuffer)
+    , arrowIndices(QOpenGLBuffer::IndexBuffer)
+    , arrowIndexCount(0)
+    , instances(QOpenGLBuffer::VertexBuffer)
+    , uploadedCount(0)
+{}
+
+/*! @brief Compiles the shaders, builds the arrow mesh and checks for instancing.  Called by the first upload().
+*/
+void GlyphRenderer::initialize()
+{
+    initializeOpenGLFunctions();
+    initialized = true;
+    valid = program.addShaderFromSourceCode(QOpenGLShader::Vertex, GLProfile::vertexHeader() + glyphVertexShader)
+         && program.addShaderFromSourceCode(QOpenGLShader::Fragment, GLProfile::fragmentHeader() + glyphFragmentShader)
+         && program.link();
+    if (!valid) {
+        qWarning() << "GlyphRenderer: could not build shaders:" << program.log();
+        return;
+    }
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    QSurfaceFormat format = context->format();
+    instanced = context->isOpenGLES() ? format.majorVersion() >= 3 : format.version() >= qMakePair(3, 3);
+    if (!instanced) qWarning() << "GlyphRenderer: no instanced arrays, arrows are drawn one by one";
+
+    instances.create();
+    instances.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    buildArrow();
+}
+
+/*! @brief Builds the arrow mesh once: a shaft of radius 0.01 up to 0.9, and a cone of radius 0.03 from there to the tip at 1.
+*/
+void GlyphRenderer::buildArrow()
+{
+    std::vector<GLfloat> vertices;
+    std::vector<GLuint> indices;
+    const GLfloat shaft = 0.01f, head = 0.03f, neck = 0.9f;
+    for (int k = 0; k < arrowSides; ++k) {
+        double angle = 2 * M_PI * k / arrowSides;
+        GLfloat c = GLfloat(cos(angle)), s = GLfloat(sin(angle)), shade = GLfloat(0.75 + 0.25 * cos(angle - M_PI / 4));
+        GLfloat ring[4][4] = { { shaft * c, shaft * s, 0.f, shade }, { shaft * c, shaft * s, neck, shade },
+                               { head * c, head * s, neck, shade }, { head * c, head * s, neck, 0.6f } };
+        for (int r = 0; r < 4; ++r) vertices.insert(vertices.end(), ring[r], ring[r] + 4);
+    }
+    GLuint tip = GLuint(vertices.size() / 4);
+    static const GLfloat tipVertex[4] = { 0.f, 0.f, 1.f, 1.f };
+    static const GLfloat baseVertex[4] = { 0.f, 0.f, 0.9f, 0.6f };
+    vertices.insert(vertices.end(), tipVertex, tipVertex + 4);
+    vertices.insert(vertices.end(), baseVertex, baseVertex + 4);
+    GLuint base = tip + 1;
+
+    for (int k = 0; k < arrowSides; ++k) {
+        GLuint a = GLuint(4 * k), b = GLuint(4 * ((k + 1) % arrowSides));
+        GLuint triangles[4][3] = { { a, b, a + 1 }, { b, b + 1, a + 1 },      // shaft
+                                   { a + 2, b + 2, tip },                       // cone
+                                   { a + 3, base, b + 3 } };                    // base of the cone
+        for (int t = 0; t < 4; ++t) indices.insert(indices.end(), triangles[t], triangles[t] + 3);
+    }
+
+    arrowVertices.create();
+    arrowVertices.bind();
+    arrowVertices.allocate(&vertices[0], int(vertices.size() * sizeof(GLfloat)));
+    arrowVertices.release();
+    arrowIndices.create();
+    arrowIndices.bind();
+    arrowIndices.allocate(&indices[0], int(indices.size() * sizeof(GLuint)));
+    arrowIndices.release();
+    arrowIndexCount = int(indices.size());
+}
+
+/*! @brief Uploads the arrows (floatsPerGlyph floats each) once, to be drawn any number of times with drawUploaded().
+*/
+void GlyphRenderer::upload(std::vector<GLfloat> const& glyphs)
+{
+    if (!initialized) initialize();
+    uploadedCount = 0;
+    if (!valid || glyphs.empty()) return;
+    uploadedCount = int(glyphs.size() / floatsPerGlyph);
+    if (!instanced) {
+        uploadedGlyphs = glyphs;
+        return;
+    }
+    instances.bind();
+    instances.allocate(&glyphs[0], int(glyphs.size() * sizeof(GLfloat)));
+    instances.release();
+}
+
+/*! @brief Draws count of the uploaded arrows, from the first-th, with their vectors multiplied by scale, in one color.
+*/
+void GlyphRenderer::drawUploaded(int first, int count, QMatrix4x4 const& mvp, float scale, QColor const& color)
+{
+    if (!initialized) initialize();
+    if (!valid || count <= 0 || first < 0 || first + count > uploadedCount) return;
+
+    program.bind();
+    program.setUniformValue("mvp", mvp);
+    program.setUniformValue("scale", scale);
+    program.setUniformValue("color", QVector4D(color.redF(), color.greenF(), color.blueF(), color.alphaF()));
+    arrowVertices.bind();
+    program.enableAttributeArray("vertex");
+    program.setAttributeBuffer("vertex", GL_FLOAT, 0, 4);
+    arrowVertices.release();
+    int start = program.attributeLocation("start");
+    int direction = program.attributeLocation("direction");
+    arrowIndices.bind();
+
+    if (instanced) {
+        int stride = floatsPerGlyph * sizeof(GLfloat);
+        instances.bind();
+        program.enableAttributeArray(start);
+        program.enableAttributeArray(direction);
+        program.setAttributeBuffer(start, GL_FLOAT, first * stride, 3, stride);
+        program.setAttributeBuffer(direction, GL_FLOAT, first * stride + 3 * sizeof(GLfloat), 3, stride);
+        glVertexAttribDivisor(start, 1);
+        glVertexAttribDivisor(direction, 1);
+        glDrawElementsInstanced(GL_TRIANGLES, arrowIndexCount, GL_UNSIGNED_INT, 0, count);
+        // the divisors belong to the bound vertex array object, which the other renderers share
+        glVertexAttribDivisor(start, 0);
+        glVertexAttribDivisor(direction, 0);
+        program.disableAttributeArray(start);
+        program.disableAttributeArray(direction);
+        instances.release();
+    }
+    else {
+        for (int g = first; g < first + count; ++g) {
+            GLfloat const* glyph = &uploadedGlyphs[g * floatsPerGlyph];
+            glVertexAttrib3fv(start, glyph);
+            glVertexAttrib3fv(direction, glyph + 3);
+            glDrawElements(GL_TRIANGLES, arrowIndexCount, GL_UNSIGNED_INT, 0);
+        }
+    }
+
+    arrowIndices.release();
+    program.disableAttributeArray("vertex");
+    program.release();
+}
@@ -0,0 +1,83 @@
+/*!
+ @file GlyphRenderer.h
+ @brief Draws arrows at many points from one cached arrow mesh, with instancing
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef GLYPH_RENDERER_H
+#define GLYPH_RENDERER_H
+
+#include <vector>
+#include <QtGui/QOpenGLExtraFunctions>
+#include <QtGui/QOpenGLShaderProgram>
+#include <QtGui/QOpenGLBuffer>
+#include <QtGui/QMatrix4x4>
+#include <QtGui/QColor>
+
+/*! @brief Draws a field of arrows (e.g., the orbit normals or velocities of every particle) as instances of one arrow mesh.
+
+    drawVector() builds a new Cone, trigonometry included, for every arrow it draws.  GlyphRenderer builds the arrow once, along +z
+    and one unit long (a shaft and a cone a tenth as long as the arrow, in the proportions of drawVector()), and keeps it in a
+    buffer.  Each arrow is then only floatsPerGlyph floats: where it starts (x, y, z) and the vector it shows (x, y, z), and the
+    vertex shader turns the mesh along that vector and stretches it to its length.  All arrows of a set are drawn with one
+    instanced draw call; on contexts older than OpenGL 3.3, which have no instanced arrays, with one small draw call per arrow.
+
+    A frame drawn in several viewports is passed to upload() once and each set of arrows in it drawn with drawUploaded().
+
+    All functions must be called with the widget's context current (i.e., from paintGL()).
+*/
+class GlyphRenderer : protected QOpenGLExtraFunctions
+{
+public:
+    enum { floatsPerGlyph = 6 };
+
+    GlyphRenderer();
+    void upload(std::vector<GLfloat> const& glyphs);
+    void drawUploaded(int first, int count, QMatrix4x4 const& mvp, float scale, QColor const& color);
+
+private:
+    void initialize();
+    void buildArrow();
+
+    bool initialized;
+    bool valid;
+    bool instanced;         // whether the context has instanced arrays (OpenGL 3.3 or OpenGL ES 3)
+    QOpenGLShaderProgram program;
+    QOpenGLBuffer arrowVertices;
+    QOpenGLBuffer arrowIndices;
+    int arrowIndexCount;
+    QOpenGLBuffer instances;
+    std::vector<GLfloat> uploadedGlyphs;    // kept for the draw calls per arrow when there is no instancing
+    int uploadedCount;
+};
+
+#endif
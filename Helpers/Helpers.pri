@@ -1,9 +1,47 @@
 HEADERS += 	Helpers/GLDrawingFunctions.h \
                 Helpers/Orbit.h \
                 Helpers/Point3d.h \
-                Helpers/DoubleSlider.h
+                Helpers/DoubleSlider.h \
+                Helpers/ViewFrustum.h \
+                Helpers/ParticleTrails.h \
+                Helpers/TextRenderer.h \
+                Helpers/StaticOrbitLayer.h \
+                Helpers/LineRenderer.h \
+                Helpers/DensityRenderer.h \
+                Helpers/Colormap.h \
+                Helpers/ParticleRenderer.h \
+                Helpers/FramePreparer.h \
+                Helpers/GLProfile.h \
+                Helpers/OrbitalPlaneRenderer.h \
+                Helpers/FrameScheduler.h \
+                Helpers/GlyphRenderer.h \
+                Helpers/LongExposure.h \
+                Helpers/FrameRecorder.h \
+                Helpers/FrameSink.h \
+                Helpers/StreamingImageWriter.h \
+                Helpers/RecordingManifest.h \
+                Helpers/FrameCache.h
 
 SOURCES += 	Helpers/GLDrawingFunctions.cpp \
                 Helpers/Orbit.cpp \
                 Helpers/Point3d.cpp \
-                Helpers/DoubleSlider.cpp
+                Helpers/DoubleSlider.cpp \
+                Helpers/ViewFrustum.cpp \
+                Helpers/ParticleTrails.cpp \
+                Helpers/TextRenderer.cpp \
+                Helpers/StaticOrbitLayer.cpp \
+                Helpers/LineRenderer.cpp \
+                Helpers/DensityRenderer.cpp \
+                Helpers/Colormap.cpp \
+                Helpers/ParticleRenderer.cpp \
+                Helpers/FramePreparer.cpp \
+                Helpers/GLProfile.cpp \
+                Helpers/OrbitalPlaneRenderer.cpp \
+                Helpers/FrameScheduler.cpp \
+                Helpers/GlyphRenderer.cpp \
+                Helpers/LongExposure.cpp \
+                Helpers/FrameRecorder.cpp \
+                Helpers/FrameSink.cpp \
+                Helpers/StreamingImageWriter.cpp \
+                Helpers/RecordingManifest.cpp \
+                Helpers/FrameCache.cpp
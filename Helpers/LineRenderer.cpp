@@ -0,0 +1,283 @@
+/*!
+ @file LineRenderer.cpp
+ @brief Implementation of LineRenderer, which draws thick antialiased lines by expanding them into screen-space quads in a shader.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "LineRenderer.h"
+#include "GLProfile.h"
+#include <QtCore/QDebug>
+#include <QtGui/QVector2D>
+
+static const char* lineExpansion =
+    "uniform vec2 viewport;\n"
+    "uniform float halfWidth;\n"
+    "varying float edge;\n"             // signed distance from the center line, in pixels
+    "varying vec4 lineColor;\n"
+    "vec4 expandLine(vec4 clipThis, vec4 clipOther, float side, float direction) {\n"
+    "    vec2 a = clipThis.xy / clipThis.w * viewport;\n"
+    "    vec2 b = clipOther.xy / clipOther.w * viewport;\n"
+    "    vec2 d = (b - a) * direction;\n"
+    "    edge = side * (halfWidth + 1.0);\n"
+    "    if (dot(d, d) < 1e-12) return clipThis;\n"  // zero length: collapse the quad so nothing is drawn
+    "    vec2 n = normalize(vec2(-d.y, d.x));\n"
+    "    clipThis.xy += n * edge * 2.0 / viewport * clipThis.w;\n"
+    "    return clipThis;\n"
+    "}\n";
+
+static const char* lineVertexMain =
+    "attribute vec3 position;\n"
+    "attribute vec3 other;\n"
+    "attribute vec2 corner;\n"          // side, direction
+    "attribute vec4 color;\n"          // (value, 0, 0, -1) for colormapped segments
+    "uniform mat4 mvp;\n"
+    "uniform vec4 mappedFallback;\n"
+    "void main() {\n"
+    "    lineColor = (color.a < 0.0) ? colormap(color.r, mappedFallback) : color;\n"
+    "    gl_Position = expandLine(mvp * vec4(position, 1.0), mvp * vec4(other, 1.0), corner.x, corner.y);\n"
+    "}\n";
+
+static const char* lineFragment =
+    "uniform float halfWidth;\n"
+    "varying float edge;\n"
+    "varying vec4 lineColor;\n"
+    "void main() {\n"
+    "    float coverage = clamp(halfWidth + 0.5 - abs(edge), 0.0, 1.0);\n"
+    "    gl_FragColor = vec4(lineColor.rgb, lineColor.a * coverage);\n"
+    "}\n";
+
+LineRenderer::LineRenderer()
+    : initialized(false)
+    , valid(false)
+    , lineWidth(1.f)
+    , colormap(0)
+    , streamVertices(QOpenGLBuffer::VertexBuffer)
+    , streamIndices(QOpenGLBuffer::IndexBuffer)
+    , streamSegments(0)
+    , uploadedVertices(QOpenGLBuffer::VertexBuffer)
+    , subsetIndices(QOpenGLBuffer::IndexBuffer)
+    , uploadedSegments(0)
+{}
+
+/*! @brief GLSL (without a version line) defining expandLine(clipThis, clipOther, side, direction), which returns the expanded clip position.
+*/
+char const* LineRenderer::expansionSource() { return lineExpansion; }
+
+/*! @brief Fragment shader (without a version line, see GLProfile::fragmentHeader()) turning the distance to the center line into coverage.
+*/
+char const* LineRenderer::fragmentSource() { return lineFragment; }
+
+/*! @brief Sets the uniforms used by expansionSource() and fragmentSource() on a bound program.
+*/
+void LineRenderer::setUniforms(QOpenGLShaderProgram& program, QSize const& viewport, float width)
+{
+    program.setUniformValue("viewport", QVector2D(viewport.width(), viewport.height()));
+    program.setUniformValue("halfWidth", GLfloat(width / 2.));
+}
+
+/*! @brief Appends the four vertices of a segment from a to b, with the given color (or colormap value).
+*/
+void LineRenderer::appendVertices(std::vector<GLfloat>& out, Point3d const& a, Point3d const& b, GLfloat const color[4])
+{
+    static const GLfloat corners[verticesPerSegment][2] = { { -1, 1 }, { 1, 1 }, { -1, -1 }, { 1, -1 } };
+    for (int v = 0; v < verticesPerSegment; ++v) {
+        Point3d const& p = (v < 2) ? a : b;
+        Point3d const& q = (v < 2) ? b : a;
+        GLfloat vertex[floatsPerVertex] = { GLfloat(p.x), GLfloat(p.y), GLfloat(p.z), GLfloat(q.x), GLfloat(q.y), GLfloat(q.z),
+                                            corners[v][0], corners[v][1], color[0], color[1], color[2], color[3] };
+        out.insert(out.end(), vertex, vertex + floatsPerVertex);
+    }
+}
+
+/*! @brief Appends a segment from a to b drawn in a fixed color.
+*/
+void LineRenderer::appendSegment(std::vector<GLfloat>& out, Point3d const& a, Point3d const& b, QColor const& color)
+{
+    GLfloat rgba[4] = { GLfloat(color.redF()), GLfloat(color.greenF()), GLfloat(color.blueF()), GLfloat(color.alphaF()) };
+    appendVertices(out, a, b, rgba);
+}
+
+/*! @brief Appends a segment from a to b colored by the colormap at the given attribute value.
+*/
+void LineRenderer::appendSegment(std::vector<GLfloat>& out, Point3d const& a, Point3d const& b, float value)
+{
+    GLfloat mapped[4] = { value, 0.f, 0.f, -1.f };
+    appendVertices(out, a, b, mapped);
+}
+
+/*! @brief Appends one segment per pair of consecutive points, plus one from the last point back to the first if closed is set.
+*/
+void LineRenderer::appendPolyline(std::vector<GLfloat>& out, std::vector<Point3d> const& points, QColor const& color, bool closed)
+{
+    if (points.size() < 2) return;
+    for (size_t k = 0; k + 1 < points.size(); ++k) appendSegment(out, points[k], points[k + 1], color);
+    if (closed) appendSegment(out, points.back(), points.front(), color);
+}
+
+/*! @brief Same as above, with every segment colored by the colormap at the given attribute value.
+*/
+void LineRenderer::appendPolyline(std::vector<GLfloat>& out, std::vector<Point3d> const& points, float value, bool closed)
+{
+    if (points.size() < 2) return;
+    for (size_t k = 0; k + 1 < points.size(); ++k) appendSegment(out, points[k], points[k + 1], value);
+    if (closed) appendSegment(out, points.back(), points.front(), value);
+}
+
+/*! @brief Appends the two triangles of each of the given number of segments, whose vertices start at firstVertex.
+*/
+void LineRenderer::appendIndices(std::vector<GLuint>& out, GLuint firstVertex, int segments)
+{
+    static const GLuint quad[indicesPerSegment] = { 0, 1, 2, 2, 1, 3 };
+    for (int s = 0; s < segments; ++s) {
+        GLuint base = firstVertex + s * verticesPerSegment;
+        for (int k = 0; k < indicesPerSegment; ++k) out.push_back(base + quad[k]);
+    }
+}
+
+/*! @brief Compiles the shaders and creates the streaming buffers.  Called by the first draw().
+*/
+void LineRenderer::initialize()
+{
+    initializeOpenGLFunctions();
+    initialized = true;
+    valid = program.addShaderFromSourceCode(QOpenGLShader::Vertex, GLProfile::vertexHeader() + lineExpansion + Colormap::glslSource() + lineVertexMain)
+         && program.addShaderFromSourceCode(QOpenGLShader::Fragment, GLProfile::fragmentHeader() + lineFragment)
+         && program.link();
+    if (!valid) {
+        qWarning() << "LineRenderer: could not build shaders:" << program.log();
+        return;
+    }
+    streamVertices.create();
+    streamVertices.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    streamIndices.create();
+    uploadedVertices.create();
+    uploadedVertices.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    subsetIndices.create();
+    subsetIndices.setUsagePattern(QOpenGLBuffer::StreamDraw);
+}
+
+/*! @brief Draws segments built with the append functions, uploading them first.  For geometry that changes every frame.
+*/
+void LineRenderer::draw(std::vector<GLfloat> const& vertices, QMatrix4x4 const& mvp, QSize const& viewport)
+{
+    if (!initialized) initialize();
+    if (!valid || vertices.empty()) return;
+
+    int segments = int(vertices.size() / (floatsPerVertex * verticesPerSegment));
+    reserveIndices(segments);
+    streamVertices.bind();
+    streamVertices.allocate(&vertices[0], int(vertices.size() * sizeof(GLfloat)));
+    streamVertices.release();
+
+    draw(streamVertices, streamIndices, segments * indicesPerSegment, mvp, viewport);
+}
+
+/*! @brief Makes the index pattern in streamIndices cover at least the given number of segments.
+*/
+void LineRenderer::reserveIndices(int segments)
+{
+    if (segments <= streamSegments) return;
+    std::vector<GLuint> pattern;
+    appendIndices(pattern, 0, segments);
+    streamIndices.bind();
+    streamIndices.allocate(&pattern[0], int(pattern.size() * sizeof(GLuint)));
+    streamIndices.release();
+    streamSegments = segments;
+}
+
+/*! @brief Uploads segments once, to be drawn any number of times (e.g., once per viewport) with drawUploaded().
+*/
+void LineRenderer::upload(std::vector<GLfloat> const& vertices)
+{
+    if (!initialized) initialize();
+    uploadedSegments = 0;
+    if (!valid || vertices.empty()) return;
+    uploadedSegments = int(vertices.size() / (floatsPerVertex * verticesPerSegment));
+    reserveIndices(uploadedSegments);
+    uploadedVertices.bind();
+    uploadedVertices.allocate(&vertices[0], int(vertices.size() * sizeof(GLfloat)));
+    uploadedVertices.release();
+}
+
+/*! @brief Draws all the segments passed to the last upload().
+*/
+void LineRenderer::drawUploaded(QMatrix4x4 const& mvp, QSize const& viewport)
+{
+    draw(uploadedVertices, streamIndices, uploadedSegments * indicesPerSegment, mvp, viewport);
+}
+
+/*! @brief Draws the uploaded segments with the given indices only (built with appendIndices(), e.g., for the orbits in view).
+*/
+void LineRenderer::drawUploaded(std::vector<GLuint> const& indices, QMatrix4x4 const& mvp, QSize const& viewport)
+{
+    if (!initialized) initialize();
+    if (!valid || indices.empty()) return;
+    subsetIndices.bind();
+    subsetIndices.allocate(&indices[0], int(indices.size() * sizeof(GLuint)));
+    subsetIndices.release();
+    draw(uploadedVertices, subsetIndices, int(indices.size()), mvp, viewport);
+}
+
+/*! @brief Draws segments already stored in a vertex buffer, using the given GL_UNSIGNED_INT index buffer.  One draw call.
+*/
+void LineRenderer::draw(QOpenGLBuffer& vertices, QOpenGLBuffer& indices, int indexCount, QMatrix4x4 const& mvp, QSize const& viewport)
+{
+    if (!initialized) initialize();
+    if (!valid || indexCount == 0) return;
+
+    const int stride = floatsPerVertex * sizeof(GLfloat);
+    program.bind();
+    program.setUniformValue("mvp", mvp);
+    setUniforms(program, viewport, lineWidth);
+    program.setUniformValue("mappedFallback", mappedFallback);
+    if (colormap) colormap->bind(program);
+    else program.setUniformValue("colormapEnabled", GLfloat(0.));
+
+    vertices.bind();
+    program.enableAttributeArray("position");
+    program.enableAttributeArray("other");
+    program.enableAttributeArray("corner");
+    program.enableAttributeArray("color");
+    program.setAttributeBuffer("position", GL_FLOAT, 0, 3, stride);
+    program.setAttributeBuffer("other", GL_FLOAT, 3 * sizeof(GLfloat), 3, stride);
+    program.setAttributeBuffer("corner", GL_FLOAT, 6 * sizeof(GLfloat), 2, stride);
+    program.setAttributeBuffer("color", GL_FLOAT, 8 * sizeof(GLfloat), 4, stride);
+    indices.bind();
+    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+    indices.release();
+    program.disableAttributeArray("position");
+    program.disableAttributeArray("other");
+    program.disableAttributeArray("corner");
+    program.disableAttributeArray("color");
+    vertices.release();
+    program.release();
+}
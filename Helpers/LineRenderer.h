@@ -0,0 +1,113 @@
+/*!
+ @file LineRenderer.h
+ @brief Class definition for LineRenderer, which draws thick antialiased lines by expanding them into screen-space quads in a shader.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef LINE_RENDERER_H
+#define LINE_RENDERER_H
+
+#include <vector>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLShaderProgram>
+#include <QtGui/QOpenGLBuffer>
+#include <QtGui/QMatrix4x4>
+#include <QtGui/QColor>
+#include <QtCore/QSize>
+#include "Point3d.h"
+#include "Colormap.h"
+
+/*! @brief Draws thick antialiased lines without relying on glLineWidth or GL_LINE_SMOOTH.
+
+    Wide smooth lines are an optional, often slow, feature: many drivers (Mesa's software rasterizer among them) clamp the
+    width or fall back to a slow path.  Here every segment is instead sent as a quad of four vertices, each holding both
+    endpoints of its segment.  The vertex shader projects the two endpoints, pushes the vertex away from the segment along its
+    screen-space normal by half the width plus one pixel, and passes the signed distance to the center line on to the fragment
+    shader, which turns it into coverage.  The result is the same on every driver and in offscreen recordings.
+
+    A vertex is floatsPerVertex floats: this endpoint (x, y, z), the other endpoint (x, y, z), the side of the line (+1 or -1),
+    the direction (+1 if the other endpoint is the end of the segment, -1 if it is the start) and a color (r, g, b, a).  The
+    append functions build such arrays, either to be drawn right away with draw(), to be uploaded once and drawn several times
+    (e.g., in several viewports) with upload() and drawUploaded(), or to be stored in a buffer by the caller.
+    Segments appended with an attribute value instead of a color store (value, 0, 0, -1) and are colored by the Colormap given
+    to setColormap(), or drawn in that value's fallback color if there is none.
+
+    expansionSource() is the GLSL that does the expansion, so that shaders fetching their endpoints some other way (see
+    ParticleTrails) produce identical lines.  It declares the viewport and halfWidth uniforms and the edge varying, which setUniforms()
+    and the fragment shader returned by fragmentSource() use.
+
+    All functions that touch OpenGL must be called with the widget's context current (i.e., from paintGL()).
+*/
+class LineRenderer : protected QOpenGLFunctions
+{
+public:
+    enum { floatsPerVertex = 12, verticesPerSegment = 4, indicesPerSegment = 6 };
+
+    LineRenderer();
+    static char const* expansionSource();
+    static char const* fragmentSource();
+    static void setUniforms(QOpenGLShaderProgram& program, QSize const& viewport, float width);
+    static void appendSegment(std::vector<GLfloat>& out, Point3d const& a, Point3d const& b, QColor const& color);
+    static void appendSegment(std::vector<GLfloat>& out, Point3d const& a, Point3d const& b, float value);
+    static void appendPolyline(std::vector<GLfloat>& out, std::vector<Point3d> const& points, QColor const& color, bool closed);
+    static void appendPolyline(std::vector<GLfloat>& out, std::vector<Point3d> const& points, float value, bool closed);
+    static void appendIndices(std::vector<GLuint>& out, GLuint firstVertex, int segments);
+
+    void setWidth(float pixels) { lineWidth = pixels; }
+    float width() const { return lineWidth; }
+    void setColormap(Colormap* map, QColor const& fallback) { colormap = map; mappedFallback = fallback; }
+    void draw(std::vector<GLfloat> const& vertices, QMatrix4x4 const& mvp, QSize const& viewport);
+    void draw(QOpenGLBuffer& vertices, QOpenGLBuffer& indices, int indexCount, QMatrix4x4 const& mvp, QSize const& viewport);
+    void upload(std::vector<GLfloat> const& vertices);
+    void drawUploaded(QMatrix4x4 const& mvp, QSize const& viewport);
+    void drawUploaded(std::vector<GLuint> const& indices, QMatrix4x4 const& mvp, QSize const& viewport);
+
+private:
+    void initialize();
+    void reserveIndices(int segments);
+    static void appendVertices(std::vector<GLfloat>& out, Point3d const& a, Point3d const& b, GLfloat const color[4]);
+
+    bool initialized;
+    bool valid;
+    float lineWidth;
+    Colormap* colormap;
+    QColor mappedFallback;
+    QOpenGLShaderProgram program;
+    QOpenGLBuffer streamVertices;
+    QOpenGLBuffer streamIndices;
+    int streamSegments; // number of segments the index pattern in streamIndices covers
+    QOpenGLBuffer uploadedVertices;
+    QOpenGLBuffer subsetIndices;
+    int uploadedSegments;
+};
+
+#endif
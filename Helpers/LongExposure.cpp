@@ -0,0 +1,111 @@
+/*!
+ @file LongExposure.cpp
+ @brief Adds up the particles of every frame into one image of where they have been
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "LongExposure.h"
+#include <QtCore/QElapsedTimer>
+
+LongExposure::LongExposure()
+    : data(0)
+    , frames(0)
+    , exposedCount(0)
+    , cursor(0)
+    , attribute(SingleColor)
+    , focus(-1)
+    , viewSet(false)
+{
+}
+
+/*! @brief Sets the data the frames are taken from, and the number of frames in it.  Starts a new exposure.
+*/
+void LongExposure::setData(OrbitData const* d, int f)
+{
+    preparer.setData(d, f);
+    data = d;
+    frames = d ? f : 0;
+    reset();
+}
+
+/*! @brief Starts a new exposure: no frame is exposed, and the image is cleared by the next expose() or advance().
+*/
+void LongExposure::reset()
+{
+    exposed.assign(frames, false);
+    exposedCount = 0;
+    cursor = 0;
+    viewSet = false;
+}
+
+/*! @brief Sets the view the frames are exposed in.  Starts a new exposure, and returns true, if it is not the view of the current one.
+
+    colormapKey stands for whatever else changes the particles' colors (e.g., the colormap's range), compared byte for byte.
+*/
+bool LongExposure::setView(QMatrix4x4 const& m, QSize const& v, ColorAttribute a, int id, QColor const& c, QByteArray const& key)
+{
+    if (viewSet && m == mvp && v == viewport && a == attribute && id == focus && c == color && key == colormapKey) return false;
+    reset();
+    mvp = m;
+    viewport = v;
+    attribute = a;
+    focus = id;
+    color = c;
+    colormapKey = key;
+    viewSet = true;
+    return true;
+}
+
+/*! @brief Adds the particles of the given frame, prepared elsewhere (e.g., the frame on screen), unless that frame was already exposed.
+*/
+void LongExposure::expose(int frame, std::vector<GLfloat> const& particles, DensityRenderer& density, Colormap& colormap)
+{
+    if (!viewSet || frame < 0 || frame >= frames || exposed[frame]) return;
+    if (exposedCount == 0) density.clearExposure();
+    density.expose(particles, mvp, viewport, color, colormap);
+    exposed[frame] = true;
+    ++exposedCount;
+}
+
+/*! @brief Exposes the next frames not yet exposed, for about msecs milliseconds.
+*/
+void LongExposure::advance(int msecs, DensityRenderer& density, Colormap& colormap)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (viewSet && !complete() && timer.elapsed() < msecs) {
+        while (cursor < frames && exposed[cursor]) ++cursor;
+        if (cursor >= frames) break;
+        PreparedFrame const& frame = preparer.acquire(cursor, attribute, focus, false, false, false);
+        expose(cursor, frame.particles, density, colormap);
+    }
+}
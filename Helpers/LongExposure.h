@@ -0,0 +1,90 @@
+/*!
+ @file LongExposure.h
+ @brief Adds up the particles of every frame into one image of where they have been
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef LONG_EXPOSURE_H
+#define LONG_EXPOSURE_H
+
+#include <vector>
+#include <QtGui/QMatrix4x4>
+#include <QtGui/QColor>
+#include <QtCore/QSize>
+#include <QtCore/QByteArray>
+#include "FramePreparer.h"
+#include "DensityRenderer.h"
+
+/*! @brief Keeps track of a long exposure: the particles of many frames added up in DensityRenderer's exposure framebuffer.
+
+    The image only depends on the view (the matrix, the viewport size and the particles' colors), not on the frame shown or on
+    what else is drawn, so it is kept as long as setView() is given the same view, and each frame is added at most once.  The
+    frame on screen is added as it is drawn (see expose()), so playing the simulation exposes the frames it plays, and advance()
+    adds the frames not yet exposed, in order, for a given time per call, so that the whole run is exposed in the background
+    while the widget keeps repainting.  Those frames are gathered by a FramePreparer of its own, which prepares the next one on a
+    worker thread while the current one is drawn.
+
+    The frames are prepared relative to the focus particle (see PreparedFrame::origin), so with one the exposure shows the
+    paths around it rather than around the central body.
+
+    Like FramePreparer, the data passed to setData() must not change while a job may be running: call setData() again first.
+*/
+class LongExposure
+{
+public:
+    LongExposure();
+    void setData(OrbitData const* data, int frames);
+    void reset();
+    bool setView(QMatrix4x4 const& mvp, QSize const& viewport, ColorAttribute attribute, int focus, QColor const& color,
+                 QByteArray const& colormapKey);
+    void expose(int frame, std::vector<GLfloat> const& particles, DensityRenderer& density, Colormap& colormap);
+    void advance(int msecs, DensityRenderer& density, Colormap& colormap);
+    bool complete() const { return exposedCount >= frames; }
+    int exposedFrames() const { return exposedCount; }
+
+private:
+    OrbitData const* data;
+    int frames;
+    std::vector<bool> exposed;
+    int exposedCount;
+    int cursor;             // the frames before it have all been exposed
+    QMatrix4x4 mvp;
+    QSize viewport;
+    ColorAttribute attribute;
+    int focus;
+    QColor color;
+    QByteArray colormapKey;
+    bool viewSet;
+    FramePreparer preparer;
+};
+
+#endif
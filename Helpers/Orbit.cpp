@@ -59,6 +59,52 @@ void Orbit::calculateOrbit(double* cosfs, double* sinfs) {
     posInPlane.z = orbitCoords[f].z;
 }
 
+/*! @brief Rotates a point from the orbital plane (x toward pericenter) into the reference frame.
+
+    Applies the same Omega, i, w rotations (in degrees) that the OrbitalAnimator passes to glRotatef before drawing an orbit.
+*/
+Point3d Orbit::toReferenceFrame(Point3d const& p) const {
+    double cw = cos(DegToRad(w)), sw = sin(DegToRad(w));
+    double ci = cos(DegToRad(i)), si = sin(DegToRad(i));
+    double cO = cos(DegToRad(Omega)), sO = sin(DegToRad(Omega));
+
+    double x1 = p.x * cw - p.y * sw;
+    double y1 = p.x * sw + p.y * cw;
+    double y2 = y1 * ci - p.z * si;
+    double z2 = y1 * si + p.z * ci;
+    return Point3d(x1 * cO - y2 * sO, x1 * sO + y2 * cO, z2);
+}
+
+/*! @brief Returns the particle's position in the reference frame, whether the data came as orbital elements or as xyz.
+*/
+Point3d Orbit::position() const {
+    return hasOrbEls ? toReferenceFrame(posInPlane) : posInPlane;
+}
+
+/*! @brief Returns the unit vector along the orbit's angular momentum (Omega and i in degrees, or r x v for xyz data).
+*/
+Point3d Orbit::normal() const {
+    if (!hasOrbEls) {
+        Point3d h = crossProduct(Point3d(r[0], r[1], r[2]), Point3d(v[0], v[1], v[2]));
+        return magnitude(h) > 0 ? unitVectorFrom(h) : Point3d(0, 0, 1);
+    }
+    double si = sin(DegToRad(i));
+    return Point3d(sin(DegToRad(Omega)) * si, -cos(DegToRad(Omega)) * si, cos(DegToRad(i)));
+}
+
+/*! @brief Returns the particle's velocity in the reference frame, whether the data came as orbital elements or as xyz.
+
+    From the elements, the velocity in the orbital plane at true anomaly f (in degrees) is sqrt(mu / p) (-sin f, e + cos f, 0),
+    with p = a (1 - e^2), which is then rotated like the position.
+*/
+Point3d Orbit::velocity() const {
+    if (!hasOrbEls) return Point3d(v[0], v[1], v[2]);
+    double p = axis * (1 - e * e);
+    double speed = p > 0 ? sqrt(mu / p) : 0;
+    double cf = cos(DegToRad(f)), sf = sin(DegToRad(f));
+    return toReferenceFrame(Point3d(-speed * sf, speed * (e + cf), 0));
+}
+
 void Orbit::checkElements()
 {
     if(mu < 0)
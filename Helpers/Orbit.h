@@ -50,16 +50,22 @@ inline double RadToDeg(double rad) { return(rad*180/M_PI); }
 
 class Orbit {
 public:
-    Orbit() : hasCoords(false), hasOrbEls(false), color(0.0, 1.0, 0.0, 1.0), particleSize(0.003) {}
+    Orbit() : mu(1.), hasCoords(false), hasOrbEls(false), particleSize(0.003) {}
     void calculatePosition(double* cosfs, double* sinfs);
     void calculateOrbit(double* cosNus, double* sinfs);
     void convertOrbElsToPos(Point3d& v, double* cosfs, double* sinfs, double f);
     void xyz2osc();
     void osc2xyz();
     void checkElements();
+    Point3d toReferenceFrame(Point3d const& p) const;
+    Point3d position() const;
+    Point3d normal() const;
+    Point3d velocity() const;
+    double periapsis() const { return axis * (1 - e); }
+    double apoapsis() const { return axis * (1 + e); }
 
     double time, particleID, axis, e, i, Omega, w, l, P, f;
-    double mu;      // G * mass of central objects (needed in order to convert from xyz to osc)
+    double mu;      // G * mass of central objects (needed in order to convert from xyz to osc); 1 unless a reader sets it
 
     Eigen::Vector3d r;
     Eigen::Vector3d v;
@@ -68,7 +74,6 @@ public:
 
     bool hasCoords;
     bool hasOrbEls;
-    Color color;
     double particleSize;
 
 };
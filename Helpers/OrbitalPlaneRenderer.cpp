@@ -0,0 +1,369 @@
+/*!
+ @file OrbitalPlaneRenderer.cpp
+ @brief Implementation of OrbitalPlaneRenderer, which fills the orbital planes with order-independent transparency.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "OrbitalPlaneRenderer.h"
+#include "GLProfile.h"
+#include <QtGui/QOpenGLContext>
+#include <QtCore/QDebug>
+#include <QtCore/QRect>
+#include <QtGui/QVector4D>
+
+#ifndef GL_RGBA16F
+#define GL_RGBA16F 0x881A
+#endif
+
+#ifndef GL_FRAMEBUFFER_BINDING
+#define GL_FRAMEBUFFER_BINDING 0x8CA6
+#endif
+
+#ifndef GL_SAMPLE_BUFFERS
+#define GL_SAMPLE_BUFFERS 0x80A8
+#endif
+
+static const char* accumulateVertexShader =
+    "attribute vec3 position;\n"
+    "uniform mat4 mvp;\n"
+    "void main() {\n"
+    "    gl_Position = mvp * vec4(position, 1.0);\n"
+    "}\n";
+
+static const char* accumulateFragmentShader =
+    "uniform vec4 color;\n"
+    "void main() {\n"
+    "    float a = color.a;\n"
+    // McGuire and Bavoil's weight: nearer and more opaque fragments count more
+    "    float w = clamp(pow(min(1.0, a * 10.0) + 0.01, 3.0) * 1e8 * pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);\n"
+    "    gl_FragData[0] = vec4(color.rgb * a * w, a);\n"        // a multiplies the revealage through ONE_MINUS_SRC_ALPHA
+    "    gl_FragData[1] = vec4(a * w, 0.0, 0.0, 0.0);\n"
+    "}\n";
+
+static const char* blendFragmentShader =
+    "uniform vec4 color;\n"
+    "void main() {\n"
+    "    gl_FragColor = color;\n"
+    "}\n";
+
+static const char* compositeVertexShader =
+    "attribute vec2 corner;\n"
+    "varying vec2 uv;\n"
+    "void main() {\n"
+    "    uv = 0.5 * corner + 0.5;\n"
+    "    gl_Position = vec4(corner, 0.0, 1.0);\n"
+    "}\n";
+
+static const char* compositeFragmentShader =
+    "uniform sampler2D accumulated;\n"
+    "uniform sampler2D weights;\n"
+    "varying vec2 uv;\n"
+    "void main() {\n"
+    "    vec4 sum = texture2D(accumulated, uv);\n"
+    "    if (sum.a >= 1.0) discard;\n"                            // no plane covers this pixel
+    "    float w = texture2D(weights, uv).r;\n"
+    "    gl_FragColor = vec4(sum.rgb / max(w, 1e-5), 1.0 - sum.a);\n"
+    "}\n";
+
+OrbitalPlaneRenderer::OrbitalPlaneRenderer()
+    : initialized(false)
+    , valid(false)
+    , weighted(false)
+    , depthWarned(false)
+    , vertexBuffer(QOpenGLBuffer::VertexBuffer)
+    , indexBuffer(QOpenGLBuffer::IndexBuffer)
+    , subsetBuffer(QOpenGLBuffer::IndexBuffer)
+    , uploadedIndices(0)
+    , quad(QOpenGLBuffer::VertexBuffer)
+    , target(0)
+    , resolved(0)
+{}
+
+OrbitalPlaneRenderer::~OrbitalPlaneRenderer()
+{
+    delete target;
+    delete resolved;
+}
+
+/*! @brief Compiles the shaders, creates the buffers and checks for the OpenGL 3.0 functions of the OIT.  Called by the first
+    upload() or draw().
+*/
+void OrbitalPlaneRenderer::initialize()
+{
+    initializeOpenGLFunctions();
+    initialized = true;
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    QSurfaceFormat format = context->format();
+    weighted = context->isOpenGLES() ? format.majorVersion() >= 3 : format.version() >= qMakePair(3, 0);
+    if (!weighted) qWarning() << "OrbitalPlaneRenderer: no OpenGL 3.0, orbital planes are blended in drawing order";
+    valid = blendProgram.addShaderFromSourceCode(QOpenGLShader::Vertex, GLProfile::vertexHeader() + accumulateVertexShader)
+         && blendProgram.addShaderFromSourceCode(QOpenGLShader::Fragment, GLProfile::fragmentHeader() + blendFragmentShader)
+         && blendProgram.link()
+         && accumulateProgram.addShaderFromSourceCode(QOpenGLShader::Vertex, GLProfile::vertexHeader() + accumulateVertexShader)
+         && accumulateProgram.addShaderFromSourceCode(QOpenGLShader::Fragment, GLProfile::fragmentHeader() + accumulateFragmentShader)
+         && accumulateProgram.link()
+         && compositeProgram.addShaderFromSourceCode(QOpenGLShader::Vertex, GLProfile::vertexHeader() + compositeVertexShader)
+         && compositeProgram.addShaderFromSourceCode(QOpenGLShader::Fragment, GLProfile::fragmentHeader() + compositeFragmentShader)
+         && compositeProgram.link();
+    if (!valid) {
+        qWarning() << "OrbitalPlaneRenderer: could not build shaders:" << blendProgram.log() << accumulateProgram.log()
+                   << compositeProgram.log();
+        return;
+    }
+    vertexBuffer.create();
+    vertexBuffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    indexBuffer.create();
+    indexBuffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    subsetBuffer.create();
+    subsetBuffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+
+    static const GLfloat corners[8] = { -1, -1, 1, -1, -1, 1, 1, 1 };
+    quad.create();
+    quad.bind();
+    quad.allocate(corners, sizeof(corners));
+    quad.release();
+}
+
+/*! @brief (Re)creates the framebuffer with its two floating-point color buffers if the viewport size changed.  Returns false if
+    that is not supported.
+*/
+bool OrbitalPlaneRenderer::resize(QSize const& viewport)
+{
+    if (target && target->size() == viewport) return true;
+    delete target;
+    target = new QOpenGLFramebufferObject(viewport, QOpenGLFramebufferObject::CombinedDepthStencil, GL_TEXTURE_2D, GL_RGBA16F);
+    target->addColorAttachment(viewport, GL_RGBA16F);
+    if (!target->isValid() || target->textures().size() < 2) {
+        qWarning() << "OrbitalPlaneRenderer: floating-point framebuffers with two color buffers are not supported, "
+                      "orbital planes are blended in drawing order";
+        delete target;
+        target = 0;
+        return false;
+    }
+    return true;
+}
+
+/*! @brief Uploads the planes, given as fans of triangles (vertices x, y, z; GL_TRIANGLES indices), once per frame.
+*/
+void OrbitalPlaneRenderer::upload(std::vector<GLfloat> const& vertices, std::vector<GLuint> const& indices)
+{
+    if (!initialized) initialize();
+    uploadedIndices = 0;
+    if (!valid || indices.empty()) return;
+    vertexBuffer.bind();
+    vertexBuffer.allocate(&vertices[0], int(vertices.size() * sizeof(GLfloat)));
+    vertexBuffer.release();
+    indexBuffer.bind();
+    indexBuffer.allocate(&indices[0], int(indices.size() * sizeof(GLuint)));
+    indexBuffer.release();
+    uploadedIndices = int(indices.size());
+}
+
+/*! @brief Draws all the uploaded planes in one color, over the scene drawn in the current viewport.
+*/
+void OrbitalPlaneRenderer::draw(QMatrix4x4 const& mvp, QSize const& viewport, QColor const& color)
+{
+    draw(indexBuffer, uploadedIndices, mvp, viewport, color);
+}
+
+/*! @brief Draws only the triangles of the uploaded planes with the given indices (e.g., the planes in view).
+*/
+void OrbitalPlaneRenderer::draw(std::vector<GLuint> const& indices, QMatrix4x4 const& mvp, QSize const& viewport, QColor const& color)
+{
+    if (!initialized) initialize();
+    if (!valid || indices.empty()) return;
+    subsetBuffer.bind();
+    subsetBuffer.allocate(&indices[0], int(indices.size() * sizeof(GLuint)));
+    subsetBuffer.release();
+    draw(subsetBuffer, int(indices.size()), mvp, viewport, color);
+}
+
+void OrbitalPlaneRenderer::draw(QOpenGLBuffer& indices, int count, QMatrix4x4 const& mvp, QSize const& viewport, QColor const& color)
+{
+    if (!initialized) initialize();
+    if (!valid || count == 0 || viewport.isEmpty()) return;
+    if (weighted && !resize(viewport)) weighted = false;
+    if (!weighted) {
+        blend(indices, count, mvp, color);
+        return;
+    }
+
+    // the widget may itself be drawing into a framebuffer object (e.g., while recording), so put back whatever was bound,
+    // and the viewport, which may be one of several in the widget
+    GLint previous = 0, sampleBuffers = 0;
+    GLint view[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+    glGetIntegerv(GL_SAMPLE_BUFFERS, &sampleBuffers);
+    glGetIntegerv(GL_VIEWPORT, view);
+    accumulate(indices, count, mvp, color, previous, QPoint(view[0], view[1]), sampleBuffers > 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, previous);
+    glViewport(view[0], view[1], view[2], view[3]);
+
+    composite();
+}
+
+/*! @brief Copies the depth of the scene under the viewport at origin into the framebuffer.  Returns false if it could not.
+
+    A multisampled framebuffer can only be blitted to the same rectangle, so its depth is resolved into the same rectangle of
+    resolved first, which is made large enough for it.
+*/
+bool OrbitalPlaneRenderer::copySceneDepth(GLint scene, QPoint const& origin, bool multisampled)
+{
+    QSize size = target->size();
+    QRect rect(origin, size);
+    while (glGetError() != GL_NO_ERROR) { }
+    GLuint source = scene;
+    if (multisampled) {
+        QSize needed(rect.right() + 1, rect.bottom() + 1);
+        if (!resolved || resolved->width() < needed.width() || resolved->height() < needed.height()) {
+            if (resolved) needed = needed.expandedTo(resolved->size());
+            delete resolved;
+            resolved = new QOpenGLFramebufferObject(needed, QOpenGLFramebufferObject::CombinedDepthStencil);
+        }
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, scene);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolved->handle());
+        glBlitFramebuffer(rect.x(), rect.y(), rect.right() + 1, rect.bottom() + 1,
+                          rect.x(), rect.y(), rect.right() + 1, rect.bottom() + 1, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        source = resolved->handle();
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, source);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target->handle());
+    glBlitFramebuffer(rect.x(), rect.y(), rect.right() + 1, rect.bottom() + 1,
+                      0, 0, size.width(), size.height(), GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    if (glGetError() == GL_NO_ERROR) return true;
+    if (!depthWarned) {
+        qWarning() << "OrbitalPlaneRenderer: cannot copy the scene's depth, orbital planes are drawn without depth test";
+        depthWarned = true;
+    }
+    return false;
+}
+
+/*! @brief Renders the planes into the two buffers of the framebuffer, over a copy of the scene's depth under the viewport at origin.
+*/
+void OrbitalPlaneRenderer::accumulate(QOpenGLBuffer& indices, int count, QMatrix4x4 const& mvp, QColor const& color, GLint scene,
+                                      QPoint const& origin, bool multisampled)
+{
+    QSize size = target->size();
+    bool sceneDepth = copySceneDepth(scene, origin, multisampled);
+    glBindFramebuffer(GL_FRAMEBUFFER, target->handle());
+    glViewport(0, 0, size.width(), size.height());
+    static const GLenum buffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, buffers);
+    static const GLfloat opaque[4] = { 0, 0, 0, 1 };    // nothing in front: the whole background is revealed
+    static const GLfloat zero[4] = { 0, 0, 0, 0 };
+    glClearBufferfv(GL_COLOR, 0, opaque);
+    glClearBufferfv(GL_COLOR, 1, zero);
+    if (!sceneDepth) glClear(GL_DEPTH_BUFFER_BIT);
+
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    if (sceneDepth) glEnable(GL_DEPTH_TEST);
+    else glDisable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+
+    accumulateProgram.bind();
+    accumulateProgram.setUniformValue("mvp", mvp);
+    accumulateProgram.setUniformValue("color", QVector4D(color.redF(), color.greenF(), color.blueF(), color.alphaF()));
+    vertexBuffer.bind();
+    accumulateProgram.enableAttributeArray("position");
+    accumulateProgram.setAttributeBuffer("position", GL_FLOAT, 0, 3);
+    indices.bind();
+    glDrawElements(GL_TRIANGLES, GLsizei(count), GL_UNSIGNED_INT, 0);
+    indices.release();
+    accumulateProgram.disableAttributeArray("position");
+    vertexBuffer.release();
+    accumulateProgram.release();
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_TRUE);
+    if (depthTest) glEnable(GL_DEPTH_TEST);
+    else glDisable(GL_DEPTH_TEST);
+}
+
+/*! @brief Blends the planes straight into whatever framebuffer is bound, in drawing order, when the OIT is not supported.
+
+    Opaque geometry still hides them through the scene's own depth test; the planes do not write depth, so none of them hides
+    another, but where they overlap the color depends on their order.
+*/
+void OrbitalPlaneRenderer::blend(QOpenGLBuffer& indices, int count, QMatrix4x4 const& mvp, QColor const& color)
+{
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    blendProgram.bind();
+    blendProgram.setUniformValue("mvp", mvp);
+    blendProgram.setUniformValue("color", QVector4D(color.redF(), color.greenF(), color.blueF(), color.alphaF()));
+    vertexBuffer.bind();
+    blendProgram.enableAttributeArray("position");
+    blendProgram.setAttributeBuffer("position", GL_FLOAT, 0, 3);
+    indices.bind();
+    glDrawElements(GL_TRIANGLES, GLsizei(count), GL_UNSIGNED_INT, 0);
+    indices.release();
+    blendProgram.disableAttributeArray("position");
+    vertexBuffer.release();
+    blendProgram.release();
+
+    glDepthMask(GL_TRUE);
+}
+
+/*! @brief Blends the weighted average color of the planes over whatever framebuffer is bound.
+*/
+void OrbitalPlaneRenderer::composite()
+{
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+
+    QVector<GLuint> textures = target->textures();
+    compositeProgram.bind();
+    compositeProgram.setUniformValue("accumulated", 0);
+    compositeProgram.setUniformValue("weights", 1);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, textures[1]);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, textures[0]);
+    quad.bind();
+    compositeProgram.enableAttributeArray("corner");
+    compositeProgram.setAttributeBuffer("corner", GL_FLOAT, 0, 2);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    compositeProgram.disableAttributeArray("corner");
+    quad.release();
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    compositeProgram.release();
+
+    if (depthTest) glEnable(GL_DEPTH_TEST);
+}
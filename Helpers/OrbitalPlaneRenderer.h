@@ -0,0 +1,109 @@
+/*!
+ @file OrbitalPlaneRenderer.h
+ @brief Class definition for OrbitalPlaneRenderer, which fills the orbital planes with order-independent transparency.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef ORBITAL_PLANE_RENDERER_H
+#define ORBITAL_PLANE_RENDERER_H
+
+#include <vector>
+#include <QtGui/QOpenGLExtraFunctions>
+#include <QtGui/QOpenGLShaderProgram>
+#include <QtGui/QOpenGLBuffer>
+#include <QtGui/QOpenGLFramebufferObject>
+#include <QtGui/QMatrix4x4>
+#include <QtGui/QColor>
+#include <QtCore/QSize>
+#include <QtCore/QPoint>
+
+/*! @brief Fills the planes of many orbits at once, translucent, with weighted blended order-independent transparency.
+
+    Filling each orbit with a GL_POLYGON and ordinary alpha blending gives a result that depends on the order the planes are
+    drawn in, since depth testing hides planes drawn later behind nearer ones, and it costs one immediate mode primitive per orbit.
+    Here the planes are fans of triangles around the central body (built by FramePreparer), drawn with a single glDrawElements into
+    an offscreen framebuffer with two floating-point color buffers, following McGuire and Bavoil's weighted blended OIT:
+
+    - the first buffer accumulates the premultiplied colors, weighted by a function of depth and alpha, in rgb, and the product of
+      (1 - alpha), the fraction of the background still showing, in a;
+    - the second accumulates the weights in r.
+
+    Both sums are order-independent, so no sorting is needed.  A full-screen pass then blends the weighted average color over the
+    scene with an opacity of 1 minus the product.  Both buffers are written with one glBlendFuncSeparate(ONE, ONE, ZERO,
+    ONE_MINUS_SRC_ALPHA), which needs no per-buffer blending.
+
+    The planes are uploaded once per frame and can then be drawn in several viewports, in full or only the triangles in view.
+    The depth of the scene drawn so far is copied into the offscreen framebuffer so that opaque geometry still hides the planes
+    behind it; the planes themselves do not write depth.  A multisampled scene (e.g., a recording with several samples per pixel)
+    can only be blitted to the same rectangle, so its depth is first resolved into a single-sampled framebuffer at the viewport's
+    place.  If the copy is not possible, the planes of that draw are drawn without depth test.
+    The framebuffer is created lazily and recreated when the viewport size changes.  Below OpenGL 3.0 (or ES 3.0), where there are
+    no multiple draw buffers or blits, or if the framebuffer cannot be created, the planes are instead blended straight into the
+    scene with ordinary alpha blending, in the order they were uploaded, as the immediate mode planes were.  All functions must be
+    called with the widget's context current (i.e., from paintGL()).
+*/
+class OrbitalPlaneRenderer : protected QOpenGLExtraFunctions
+{
+public:
+    OrbitalPlaneRenderer();
+    ~OrbitalPlaneRenderer();
+    void upload(std::vector<GLfloat> const& vertices, std::vector<GLuint> const& indices);
+    void draw(QMatrix4x4 const& mvp, QSize const& viewport, QColor const& color);
+    void draw(std::vector<GLuint> const& indices, QMatrix4x4 const& mvp, QSize const& viewport, QColor const& color);
+
+private:
+    void initialize();
+    bool resize(QSize const& viewport);
+    void draw(QOpenGLBuffer& indices, int count, QMatrix4x4 const& mvp, QSize const& viewport, QColor const& color);
+    bool copySceneDepth(GLint scene, QPoint const& origin, bool multisampled);
+    void accumulate(QOpenGLBuffer& indices, int count, QMatrix4x4 const& mvp, QColor const& color, GLint scene, QPoint const& origin,
+                    bool multisampled);
+    void composite();
+    void blend(QOpenGLBuffer& indices, int count, QMatrix4x4 const& mvp, QColor const& color);
+
+    bool initialized;
+    bool valid;
+    bool weighted;      // whether the weighted blended OIT is supported, see blend() otherwise
+    bool depthWarned;   // whether a failed copy of the scene's depth was reported
+    QOpenGLShaderProgram accumulateProgram;
+    QOpenGLShaderProgram compositeProgram;
+    QOpenGLShaderProgram blendProgram;
+    QOpenGLBuffer vertexBuffer;
+    QOpenGLBuffer indexBuffer;      // all the triangles passed to upload()
+    QOpenGLBuffer subsetBuffer;     // the ones passed to the last draw() of a subset
+    int uploadedIndices;
+    QOpenGLBuffer quad;
+    QOpenGLFramebufferObject* target;
+    QOpenGLFramebufferObject* resolved;     // the depth of a multisampled scene, single-sampled
+};
+
+#endif
@@ -0,0 +1,258 @@
+/*!
+ @file ParticleRenderer.cpp
+ @brief Implementation of ParticleRenderer, which draws all the particles of a frame as colored discs in one call.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "ParticleRenderer.h"
+#include "GLProfile.h"
+#include <QtCore/QDebug>
+#include <QtGui/QVector2D>
+#include <algorithm>
+
+#ifdef WIN32
+	#ifdef max
+	#undef max
+	#endif
+
+	#ifdef min
+	#undef min
+	#endif
+#endif
+
+#ifndef GL_VERTEX_PROGRAM_POINT_SIZE
+#define GL_VERTEX_PROGRAM_POINT_SIZE 0x8642
+#endif
+
+#ifndef GL_POINT_SPRITE
+#define GL_POINT_SPRITE 0x8861
+#endif
+
+#ifndef GL_ALIASED_POINT_SIZE_RANGE
+#define GL_ALIASED_POINT_SIZE_RANGE 0x846D
+#endif
+
+static const char* particleVertexMain =
+    "attribute vec4 particle;\n"        // x, y, z, attribute value
+    "uniform mat4 mvp;\n"
+    "uniform float diameter;\n"
+    "uniform vec4 color;\n"
+    "varying vec4 particleColor;\n"
+    "void main() {\n"
+    "    particleColor = colormap(particle.w, color);\n"
+    "    gl_PointSize = diameter;\n"
+    "    gl_Position = mvp * vec4(particle.xyz, 1.0);\n"
+    "}\n";
+
+static const char* particleFragmentShader =
+    "uniform float diameter;\n"
+    "varying vec4 particleColor;\n"
+    "void main() {\n"
+    "    vec2 d = 2.0 * gl_PointCoord - 1.0;\n"
+    "    float r = length(d);\n"
+    "    if (r > 1.0) discard;\n"
+    "    float coverage = clamp((1.0 - r) * 0.5 * diameter + 0.5, 0.0, 1.0);\n"
+    "    gl_FragColor = vec4(particleColor.rgb, particleColor.a * coverage);\n"
+    "}\n";
+
+static const char* discVertexShader =
+    "attribute vec2 corner;\n"          // (+-1, +-1)
+    "uniform mat4 mvp;\n"
+    "uniform vec3 center;\n"
+    "uniform vec2 radius;\n"            // in clip coordinates
+    "varying vec2 discCoord;\n"
+    "void main() {\n"
+    "    discCoord = corner;\n"
+    "    vec4 p = mvp * vec4(center, 1.0);\n"
+    "    gl_Position = p + vec4(corner * radius * p.w, 0.0, 0.0);\n"
+    "}\n";
+
+static const char* discFragmentShader =
+    "uniform float diameter;\n"         // in pixels, for the antialiased edge
+    "uniform vec4 color;\n"
+    "varying vec2 discCoord;\n"
+    "void main() {\n"
+    "    float r = length(discCoord);\n"
+    "    if (r > 1.0) discard;\n"
+    "    float coverage = clamp((1.0 - r) * 0.5 * diameter + 0.5, 0.0, 1.0);\n"
+    "    gl_FragColor = vec4(color.rgb, color.a * coverage);\n"
+    "}\n";
+
+ParticleRenderer::ParticleRenderer()
+    : initialized(false)
+    , valid(false)
+    , maxDiameter(1.f)
+    , largest(0.f)
+    , corners(QOpenGLBuffer::VertexBuffer)
+    , buffer(QOpenGLBuffer::VertexBuffer)
+    , uploaded(QOpenGLBuffer::VertexBuffer)
+    , uploadedCount(0)
+{}
+
+/*! @brief Compiles the shaders and creates the buffers.  Called by the first draw() or upload().
+*/
+void ParticleRenderer::initialize()
+{
+    initializeOpenGLFunctions();
+    initialized = true;
+    valid = program.addShaderFromSourceCode(QOpenGLShader::Vertex,
+                                            GLProfile::vertexHeader() + Colormap::glslSource() + particleVertexMain)
+         && program.addShaderFromSourceCode(QOpenGLShader::Fragment, GLProfile::fragmentHeader() + particleFragmentShader)
+         && program.link()
+         && discProgram.addShaderFromSourceCode(QOpenGLShader::Vertex, GLProfile::vertexHeader() + discVertexShader)
+         && discProgram.addShaderFromSourceCode(QOpenGLShader::Fragment, GLProfile::fragmentHeader() + discFragmentShader)
+         && discProgram.link();
+    if (!valid) {
+        qWarning() << "ParticleRenderer: could not build shaders:" << program.log() << discProgram.log();
+        return;
+    }
+    static const GLfloat quad[] = { -1.f, -1.f, 1.f, -1.f, -1.f, 1.f, 1.f, 1.f };
+    corners.create();
+    corners.bind();
+    corners.allocate(quad, int(sizeof(quad)));
+    corners.release();
+    buffer.create();
+    buffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    uploaded.create();
+    uploaded.setUsagePattern(QOpenGLBuffer::StreamDraw);
+
+    GLfloat range[2] = { 1.f, 1.f };
+    glGetFloatv(GL_ALIASED_POINT_SIZE_RANGE, range);
+    maxDiameter = std::max(range[1], 1.f);
+}
+
+/*! @brief Uploads the particles once, to be drawn any number of times (e.g., once per viewport) with drawUploaded().
+*/
+void ParticleRenderer::upload(std::vector<GLfloat> const& particles)
+{
+    if (!initialized) initialize();
+    uploadedCount = 0;
+    if (!valid || particles.empty()) return;
+    uploaded.bind();
+    uploaded.allocate(&particles[0], int(particles.size() * sizeof(GLfloat)));
+    uploaded.release();
+    uploadedCount = int(particles.size() / floatsPerParticle);
+}
+
+/*! @brief Draws the particles passed to the last upload(), like draw().
+*/
+void ParticleRenderer::drawUploaded(QMatrix4x4 const& mvp, float diameter, QColor const& color, Colormap& colormap)
+{
+    drawBuffer(uploaded, uploadedCount, mvp, diameter, color, &colormap);
+}
+
+/*! @brief Draws the particles as discs of the given diameter in pixels (at least one pixel, and at most the largest point size
+    the driver supports).  The particles are uploaded to a buffer of their own, which leaves the uploaded ones alone.
+*/
+void ParticleRenderer::draw(std::vector<GLfloat> const& particles, QMatrix4x4 const& mvp, float diameter, QColor const& color, Colormap& colormap)
+{
+    draw(particles, mvp, diameter, color, &colormap);
+}
+
+/*! @brief Same as above, with every particle drawn in the given color.
+*/
+void ParticleRenderer::draw(std::vector<GLfloat> const& particles, QMatrix4x4 const& mvp, float diameter, QColor const& color)
+{
+    draw(particles, mvp, diameter, color, 0);
+}
+
+/*! @brief Draws a disc of the given diameter in the units of center, which is as large on the screen as a sphere of that diameter.
+
+    mvp is affine (the projection is orthographic), so the sphere's outline spans the length of the first (second) row of the
+    linear part of mvp times its radius along x (y) in clip coordinates, however the view is rotated.  viewport is the size of
+    the view in pixels, for the antialiased edge.  Unlike draw(), the size is not limited.
+*/
+void ParticleRenderer::drawDisc(QVector3D const& center, QMatrix4x4 const& mvp, float diameter, QSize const& viewport, QColor const& color)
+{
+    if (!initialized) initialize();
+    if (!valid || diameter <= 0) return;
+    QVector2D radius(QVector3D(mvp(0, 0), mvp(0, 1), mvp(0, 2)).length(), QVector3D(mvp(1, 0), mvp(1, 1), mvp(1, 2)).length());
+    radius *= 0.5f * diameter;
+    float pixels = std::max(1.f, std::min(radius.x() * viewport.width(), radius.y() * viewport.height()));
+
+    discProgram.bind();
+    discProgram.setUniformValue("mvp", mvp);
+    discProgram.setUniformValue("center", center);
+    discProgram.setUniformValue("radius", radius);
+    discProgram.setUniformValue("diameter", GLfloat(pixels));
+    discProgram.setUniformValue("color", color);
+    corners.bind();
+    discProgram.enableAttributeArray("corner");
+    discProgram.setAttributeBuffer("corner", GL_FLOAT, 0, 2);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    discProgram.disableAttributeArray("corner");
+    corners.release();
+    discProgram.release();
+}
+
+void ParticleRenderer::draw(std::vector<GLfloat> const& particles, QMatrix4x4 const& mvp, float diameter, QColor const& color, Colormap* colormap)
+{
+    if (!initialized) initialize();
+    if (!valid || particles.empty()) return;
+    buffer.bind();
+    buffer.allocate(&particles[0], int(particles.size() * sizeof(GLfloat)));
+    buffer.release();
+    drawBuffer(buffer, int(particles.size() / floatsPerParticle), mvp, diameter, color, colormap);
+}
+
+void ParticleRenderer::drawBuffer(QOpenGLBuffer& particles, int count, QMatrix4x4 const& mvp, float diameter, QColor const& color,
+                                  Colormap* colormap)
+{
+    if (!initialized) initialize();
+    if (!valid) return;
+    diameter = std::max(1.f, std::min(diameter, maxDiameter));
+    largest = std::max(largest, diameter);  // even with no particles in view, for renderPoster()'s guard band
+    if (count == 0) return;
+
+    // Point sprites are always on in a core-profile context, where GL_POINT_SPRITE is not a valid capability.
+    bool sprites = !GLProfile::core();
+    glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
+    if (sprites) glEnable(GL_POINT_SPRITE);
+
+    program.bind();
+    program.setUniformValue("mvp", mvp);
+    program.setUniformValue("diameter", GLfloat(diameter));
+    program.setUniformValue("color", color);
+    if (colormap) colormap->bind(program);
+    else program.setUniformValue("colormapEnabled", GLfloat(0.));
+
+    particles.bind();
+    program.enableAttributeArray("particle");
+    program.setAttributeBuffer("particle", GL_FLOAT, 0, floatsPerParticle);
+    glDrawArrays(GL_POINTS, 0, GLsizei(count));
+    program.disableAttributeArray("particle");
+    particles.release();
+    program.release();
+
+    if (sprites) glDisable(GL_POINT_SPRITE);
+    glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
+}
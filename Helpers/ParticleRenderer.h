@@ -0,0 +1,96 @@
+/*!
+ @file ParticleRenderer.h
+ @brief Class definition for ParticleRenderer, which draws all the particles of a frame as colored discs in one call.  It is used only by OrbitalAnimator.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef PARTICLE_RENDERER_H
+#define PARTICLE_RENDERER_H
+
+#include <vector>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLShaderProgram>
+#include <QtGui/QOpenGLBuffer>
+#include <QtGui/QMatrix4x4>
+#include <QtGui/QVector3D>
+#include <QtCore/QSize>
+#include <QtGui/QColor>
+#include "Colormap.h"
+
+/*! @brief Draws every particle of a frame as a screen-aligned disc with one glDrawArrays.
+
+    The particles are passed as floatsPerParticle floats each: the world position (x, y, z) and the value of the attribute they
+    are colored by (see Colormap).  The array is uploaded once per frame; each particle becomes one point sprite whose size is the
+    particle's diameter in pixels, cut to a disc with an antialiased edge in the fragment shader.
+
+    Point sprites are at most as large as the driver allows, so bodies with a size in world units (the central body) are drawn
+    with drawDisc() instead, as a quad that keeps growing with the zoom.
+
+    A frame drawn in several viewports is passed to upload() once and drawn in each with drawUploaded(); the uploaded buffer can
+    also be read by other renderers (see DensityRenderer) through uploadedBuffer().
+
+    All functions must be called with the widget's context current (i.e., from paintGL()).
+*/
+class ParticleRenderer : protected QOpenGLFunctions
+{
+public:
+    enum { floatsPerParticle = 4 };
+
+    ParticleRenderer();
+    void draw(std::vector<GLfloat> const& particles, QMatrix4x4 const& mvp, float diameter, QColor const& color, Colormap& colormap);
+    void draw(std::vector<GLfloat> const& particles, QMatrix4x4 const& mvp, float diameter, QColor const& color);
+    void upload(std::vector<GLfloat> const& particles);
+    void drawUploaded(QMatrix4x4 const& mvp, float diameter, QColor const& color, Colormap& colormap);
+    void drawDisc(QVector3D const& center, QMatrix4x4 const& mvp, float diameter, QSize const& viewport, QColor const& color);
+    QOpenGLBuffer& uploadedBuffer() { return uploaded; }
+    void resetLargestDiameter() { largest = 0.f; }
+    float largestDiameter() const { return largest; }
+    int uploadedParticles() const { return uploadedCount; }
+
+private:
+    void initialize();
+    void draw(std::vector<GLfloat> const& particles, QMatrix4x4 const& mvp, float diameter, QColor const& color, Colormap* colormap);
+    void drawBuffer(QOpenGLBuffer& particles, int count, QMatrix4x4 const& mvp, float diameter, QColor const& color, Colormap* colormap);
+
+    bool initialized;
+    bool valid;
+    float maxDiameter;
+    float largest;              // the largest diameter, in pixels, asked of draw() or drawUploaded() since resetLargestDiameter()
+    QOpenGLShaderProgram program;
+    QOpenGLShaderProgram discProgram;
+    QOpenGLBuffer corners;      // the corners of the quad drawn by drawDisc()
+    QOpenGLBuffer buffer;       // for the particles passed to draw()
+    QOpenGLBuffer uploaded;     // for the particles passed to upload()
+    int uploadedCount;
+};
+
+#endif
@@ -0,0 +1,282 @@
+/*!
+ @file ParticleTrails.cpp
+ @brief Implementation of ParticleTrails, which keeps a GPU ring buffer of recent particle positions and draws them as fading trails.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "ParticleTrails.h"
+#include "GLProfile.h"
+#include <QtCore/QDebug>
+#include <QtGui/QVector2D>
+#include <algorithm>
+
+#ifdef WIN32
+	#ifdef max
+	#undef max
+	#endif
+
+	#ifdef min
+	#undef min
+	#endif
+#endif
+
+#ifndef GL_RGBA32F
+#define GL_RGBA32F 0x8814
+#endif
+
+static const char* trailVertexMain =
+    "attribute vec4 trailCoord;\n"      // particle index, age of this end, age of the other end (0 = newest), side
+    "uniform mat4 mvp;\n"
+    "uniform sampler2D history;\n"
+    "uniform vec2 historySize;\n"
+    "uniform float columns;\n"
+    "uniform float rowsPerSlot;\n"
+    "uniform float trailLength;\n"
+    "uniform float head;\n"
+    "uniform float filled;\n"
+    "uniform vec4 color;\n"
+    "vec4 fetch(float age) {\n"
+    "    float slot = mod(head - min(age, filled - 1.0) + trailLength, trailLength);\n"
+    "    vec2 texel = vec2(mod(trailCoord.x, columns), slot * rowsPerSlot + floor(trailCoord.x / columns));\n"
+    "    return texture2DLod(history, (texel + 0.5) / historySize, 0.0);\n"
+    "}\n"
+    "void main() {\n"
+    "    vec4 p = fetch(trailCoord.y);\n"
+    "    vec4 q = fetch(trailCoord.z);\n"
+    "    float fade = p.w * q.w * (1.0 - trailCoord.y / trailLength);\n"
+    "    if (max(trailCoord.y, trailCoord.z) > filled - 1.0) fade = 0.0;\n"  // older than the history kept so far
+    "    lineColor = vec4(color.rgb, color.a * fade * fade);\n"
+    "    gl_Position = expandLine(mvp * vec4(p.xyz, 1.0), mvp * vec4(q.xyz, 1.0), trailCoord.w, sign(trailCoord.z - trailCoord.y));\n"
+    "}\n";
+
+ParticleTrails::ParticleTrails(int length)
+    : initialized(false)
+    , valid(false)
+    , vertices(QOpenGLBuffer::VertexBuffer)
+    , indices(QOpenGLBuffer::IndexBuffer)
+    , history(0)
+    , trailLength(std::max(length, 2))
+    , particleCount(0)
+    , columns(1)
+    , rowsPerSlot(1)
+    , indexCount(0)
+    , head(0)
+    , filled(0)
+    , lastFrame(-1)
+{}
+
+ParticleTrails::~ParticleTrails()
+{
+    if (history) glDeleteTextures(1, &history);
+}
+
+/*! @brief Changes the number of frames in a trail.  The ring is reallocated on the next update().
+*/
+void ParticleTrails::setLength(int length)
+{
+    length = std::max(length, 2);
+    if (length == trailLength) return;
+    trailLength = length;
+    particleCount = 0;
+    lastFrame = -1;
+}
+
+/*! @brief Forgets the stored history, e.g. when the simulation data is replaced or cleared.
+*/
+void ParticleTrails::reset()
+{
+    particleCount = 0;
+    lastFrame = -1;
+    filled = 0;
+}
+
+/*! @brief Compiles the shaders and creates the buffers.  Called the first time the trails are updated.
+*/
+void ParticleTrails::initialize()
+{
+    initializeOpenGLFunctions();
+    initialized = true;
+    valid = program.addShaderFromSourceCode(QOpenGLShader::Vertex,
+                                            GLProfile::vertexHeader() + LineRenderer::expansionSource() + trailVertexMain)
+         && program.addShaderFromSourceCode(QOpenGLShader::Fragment, GLProfile::fragmentHeader() + LineRenderer::fragmentSource())
+         && program.link();
+    if (!valid) {
+        qWarning() << "ParticleTrails: could not build shaders:" << program.log();
+        return;
+    }
+    vertices.create();
+    indices.create();
+    glGenTextures(1, &history);
+}
+
+/*! @brief Sizes the history texture and builds the static trail geometry for the given number of particles.
+*/
+void ParticleTrails::allocate(int particles)
+{
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+
+    particleCount = particles;
+    columns = std::max(1, std::min(particles, int(maxSize)));
+    rowsPerSlot = (particles + columns - 1) / columns;
+    if (rowsPerSlot * trailLength > maxSize) {
+        trailLength = std::max(2, int(maxSize) / rowsPerSlot);
+        qWarning() << "ParticleTrails: too many particles for the requested trail, shortening it to" << trailLength << "frames";
+    }
+
+    glBindTexture(GL_TEXTURE_2D, history);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, columns, rowsPerSlot * trailLength, 0, GL_RGBA, GL_FLOAT, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    static const GLfloat corners[LineRenderer::verticesPerSegment][2] = { { 0, -1 }, { 0, 1 }, { 1, -1 }, { 1, 1 } };
+    std::vector<GLfloat> coords;
+    coords.reserve(4 * LineRenderer::verticesPerSegment * particles * (trailLength - 1));
+    for (int p = 0; p < particles; ++p) {
+        for (int age = 0; age < trailLength - 1; ++age) {
+            for (int v = 0; v < LineRenderer::verticesPerSegment; ++v) {
+                GLfloat end = corners[v][0];
+                coords.push_back(p);
+                coords.push_back(age + end);
+                coords.push_back(age + 1 - end);
+                coords.push_back(corners[v][1]);
+            }
+        }
+    }
+    vertices.bind();
+    vertices.allocate(&coords[0], int(coords.size() * sizeof(GLfloat)));
+    vertices.release();
+
+    std::vector<GLuint> quads;
+    LineRenderer::appendIndices(quads, 0, particles * (trailLength - 1));
+    indexCount = int(quads.size());
+    indices.bind();
+    indices.allocate(&quads[0], int(quads.size() * sizeof(GLuint)));
+    indices.release();
+
+    slotData.resize(4 * columns * rowsPerSlot);
+    lastFrame = -1;
+    filled = 0;
+}
+
+/*! @brief Uploads the positions of every particle at the given frame into one ring slot.
+
+    Particles with fewer frames than the one requested keep their last position, flagged in w so the shader hides that part of
+    their trail.
+*/
+void ParticleTrails::writeSlot(int slot, OrbitData const& data, int frame)
+{
+    int p = 0;
+    for (OrbitData::const_iterator itr = data.begin(); itr != data.end(); ++itr, ++p) {
+        std::vector<Orbit> const& samples = itr->second;
+        float* texel = &slotData[4 * p];
+        if (samples.empty()) { texel[0] = texel[1] = texel[2] = texel[3] = 0; continue; }
+        Point3d pos = samples[std::min(size_t(frame), samples.size() - 1)].position();
+        texel[0] = pos.x;
+        texel[1] = pos.y;
+        texel[2] = pos.z;
+        texel[3] = (size_t(frame) < samples.size()) ? 1.f : 0.f;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, history);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, slot * rowsPerSlot, columns, rowsPerSlot, GL_RGBA, GL_FLOAT, &slotData[0]);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+/*! @brief Brings the ring up to date with the given frame.
+
+    Moving forward by less than a trail length appends only the frames in between (one upload each); anything else refills the ring.
+*/
+void ParticleTrails::update(OrbitData const& data, int frame)
+{
+    if (!initialized) initialize();
+    if (!valid || data.empty()) return;
+    if (particleCount != int(data.size())) allocate(int(data.size()));
+    if (frame == lastFrame) return;
+
+    int first;
+    if (lastFrame >= 0 && frame > lastFrame && frame - lastFrame < trailLength) {
+        first = lastFrame + 1;
+    }
+    else {
+        first = std::max(0, frame - trailLength + 1);
+        filled = 0;
+    }
+
+    for (int f = first; f <= frame; ++f) {
+        head = (filled == 0 && f == first) ? 0 : (head + 1) % trailLength;
+        writeSlot(head, data, f);
+        filled = std::min(filled + 1, trailLength);
+    }
+    lastFrame = frame;
+}
+
+/*! @brief Draws every particle's trail, width pixels wide, with a single glDrawElements call.
+*/
+void ParticleTrails::draw(QMatrix4x4 const& mvp, QSize const& viewport, float width, QColor const& color)
+{
+    if (!valid || filled < 2) return;
+
+    glEnable(GL_BLEND);
+    glDepthMask(GL_FALSE);
+
+    program.bind();
+    program.setUniformValue("mvp", mvp);
+    program.setUniformValue("history", 0);
+    program.setUniformValue("historySize", QVector2D(columns, rowsPerSlot * trailLength));
+    program.setUniformValue("columns", GLfloat(columns));
+    program.setUniformValue("rowsPerSlot", GLfloat(rowsPerSlot));
+    program.setUniformValue("trailLength", GLfloat(trailLength));
+    program.setUniformValue("head", GLfloat(head));
+    program.setUniformValue("filled", GLfloat(filled));
+    program.setUniformValue("color", color);
+    LineRenderer::setUniforms(program, viewport, width);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, history);
+
+    vertices.bind();
+    program.enableAttributeArray("trailCoord");
+    program.setAttributeBuffer("trailCoord", GL_FLOAT, 0, 4);
+    indices.bind();
+    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+    indices.release();
+    program.disableAttributeArray("trailCoord");
+    vertices.release();
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    program.release();
+    glDepthMask(GL_TRUE);
+}
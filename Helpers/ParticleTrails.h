@@ -0,0 +1,95 @@
+/*!
+ @file ParticleTrails.h
+ @brief Class definition for ParticleTrails, which keeps a GPU ring buffer of recent particle positions and draws them as fading trails.  It is used only by OrbitalAnimator.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef PARTICLE_TRAILS_H
+#define PARTICLE_TRAILS_H
+
+#include <vector>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLShaderProgram>
+#include <QtGui/QOpenGLBuffer>
+#include <QtGui/QMatrix4x4>
+#include <QtGui/QColor>
+#include "Orbit.h"
+#include "LineRenderer.h"
+
+/*! @brief Draws a fading trail behind every particle in one draw call.
+
+    The last trailLength positions of every particle are kept on the GPU in a float texture used as a ring buffer: each
+    ring slot holds one simulation frame, laid out as a block of rows (particle p of slot s lives at column p % columns of row
+    s * rowsPerSlot + p / columns).  Advancing by one frame overwrites the oldest slot with a single glTexSubImage2D, so the
+    history never has to be walked again on the CPU.  Only a seek (a jump backwards or by more than the trail length) refills
+    the ring from the OrbitData.
+
+    The geometry is static: one LineRenderer-style quad per (particle, age, age + 1) segment.  The vertex shader turns both ages
+    into ring slots using the current head, fetches the two positions from the texture, expands the segment with
+    LineRenderer::expansionSource() and fades the trail out with age.
+
+    All functions that touch OpenGL must be called with the widget's context current (i.e., from paintGL()).
+*/
+class ParticleTrails : protected QOpenGLFunctions
+{
+public:
+    ParticleTrails(int length);
+    ~ParticleTrails();
+    void setLength(int length);
+    int length() const { return trailLength; }
+    void reset();
+    void update(OrbitData const& data, int frame);
+    void draw(QMatrix4x4 const& mvp, QSize const& viewport, float width, QColor const& color);
+
+private:
+    void initialize();
+    void allocate(int particles);
+    void writeSlot(int slot, OrbitData const& data, int frame);
+
+    bool initialized;
+    bool valid;
+    QOpenGLShaderProgram program;
+    QOpenGLBuffer vertices;
+    QOpenGLBuffer indices;
+    GLuint history;
+    int trailLength;
+    int particleCount;
+    int columns;
+    int rowsPerSlot;
+    int indexCount;
+    int head;       // slot holding the newest frame
+    int filled;     // number of slots holding valid frames
+    int lastFrame;  // frame stored in the head slot, -1 if the ring is empty
+    std::vector<float> slotData;
+};
+
+#endif
@@ -70,14 +70,6 @@ Point3d Point3d::centerOf(Point3d l, Point3d r)
         l.z / 2.0 + r.z / 2.0);
 }
 
-Color::Color(unsigned char r_, unsigned char g_, unsigned char b_, unsigned char alpha_)
-    : r(r_)
-    , g(g_)
-    , b(b_)
-    , alpha(alpha_)
-{}
-Color::Color() : r(0), g(0), b(0), alpha(0) {}
-
 Point3d unitVectorFrom(Point3d const& v) {
     double mag = magnitude(v);
     return Point3d(v.x / mag, v.y / mag, v.z / mag);
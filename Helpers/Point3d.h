@@ -68,13 +68,6 @@ struct Point3d
     Point3d operator-() const { return Point3d(-x, -y, -z); }
 };
 
-struct Color
-{
-    Color(unsigned char r_, unsigned char g_, unsigned char b_, unsigned char alpha_);
-    Color();
-    unsigned char r, g, b, alpha;
-};
-
 Point3d unitVectorFrom(Point3d const& v);
 Point3d findMin(Point3d s, Point3d t);
 Point3d findMax(Point3d s, Point3d t);
@@ -0,0 +1,140 @@
+/*!
+ @file RecordingManifest.cpp
+ @brief Implementation of RecordingManifest, which remembers the frames of a recording already on disk.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "RecordingManifest.h"
+#include "FrameSink.h"
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QStringList>
+#include <QtCore/QTextStream>
+#include <QtCore/QDebug>
+
+#ifdef WIN32
+	#ifdef max
+	#undef max
+	#endif
+
+	#ifdef min
+	#undef min
+	#endif
+#endif
+
+RecordingManifest::RecordingManifest()
+    : file(0)
+{
+}
+
+RecordingManifest::~RecordingManifest()
+{
+    close();
+}
+
+/*! @brief Starts the manifest of a recording of frames first to last - 1 (all from first on if last is negative) into dir.
+
+    Reads what the manifests already in dir say is on disk, then writes this recording's own manifest with segments and the frames
+    it keeps.  Returns false if the manifest cannot be written, in which case every frame is rendered.
+*/
+bool RecordingManifest::open(QString const& path, std::vector<Segment> const& segments, int first, int last)
+{
+    close();
+    kept.clear();
+    QDir dir(path);
+    QStringList manifests = dir.entryList(QStringList() << "ogre-recording*.manifest", QDir::Files);
+    for (int i = 0; i < manifests.size(); ++i) readManifest(dir.absoluteFilePath(manifests[i]), segments, dir);
+
+    QString name = (first == 0 && last < 0) ? QString("ogre-recording.manifest")
+                                           : QString("ogre-recording.%1-%2.manifest").arg(first).arg(last);
+    file = fopen(QFile::encodeName(dir.absoluteFilePath(name)).constData(), "w");
+    if (!file) {
+        qWarning() << "RecordingManifest: could not write" << dir.absoluteFilePath(name);
+        kept.clear();
+        return false;
+    }
+    fprintf(file, "ogre-recording 1\n");
+    for (size_t s = 0; s < segments.size(); ++s)
+        fprintf(file, "segment %d %d %s\n", segments[s].first, segments[s].count, segments[s].hash.constData());
+    for (std::set<int>::const_iterator f = kept.begin(); f != kept.end(); ++f) fprintf(file, "frame %d\n", *f);
+    fflush(file);
+    return true;
+}
+
+/*! @brief Adds to kept the frames of the manifest at path that segments still has, and that are in dir.
+*/
+void RecordingManifest::readManifest(QString const& path, std::vector<Segment> const& segments, QDir const& dir)
+{
+    QFile in(path);
+    if (!in.open(QIODevice::ReadOnly | QIODevice::Text)) return;
+    QTextStream stream(&in);
+    if (stream.readLine() != "ogre-recording 1") return;
+
+    std::vector<Segment> old;
+    while (!stream.atEnd()) {
+        QStringList fields = stream.readLine().split(' ', QString::SkipEmptyParts);
+        if (fields.size() == 4 && fields[0] == "segment") {
+            Segment s = { fields[1].toInt(), fields[2].toInt(), fields[3].toLatin1() };
+            old.push_back(s);
+        }
+        else if (fields.size() == 2 && fields[0] == "frame") {
+            int frame = fields[1].toInt();
+            for (size_t s = 0; s < old.size(); ++s) {
+                if (frame < old[s].first || frame >= old[s].first + old[s].count) continue;
+                for (size_t n = 0; n < segments.size(); ++n)
+                    if (segments[n].first == old[s].first && segments[n].count == old[s].count && segments[n].hash == old[s].hash
+                            && QFileInfo(ImageSequenceSink::fileName(dir, frame)).exists())
+                        kept.insert(frame);
+                break;
+            }
+        }
+    }
+}
+
+/*! @brief Records that frame is now saved.
+*/
+void RecordingManifest::markDone(int frame)
+{
+    QMutexLocker lock(&mutex);
+    if (!file) return;
+    fprintf(file, "frame %d\n", frame);
+    fflush(file);
+}
+
+/*! @brief Closes the manifest.  It stays in the folder, for the next recording into it.
+*/
+void RecordingManifest::close()
+{
+    QMutexLocker lock(&mutex);
+    if (file) fclose(file);
+    file = 0;
+}
@@ -0,0 +1,84 @@
+/*!
+ @file RecordingManifest.h
+ @brief Class definition for RecordingManifest, which remembers the frames of a recording already on disk.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef RECORDING_MANIFEST_H
+#define RECORDING_MANIFEST_H
+
+#include <set>
+#include <vector>
+#include <cstdio>
+#include <QtCore/QByteArray>
+#include <QtCore/QDir>
+#include <QtCore/QMutex>
+#include <QtCore/QString>
+
+/*! @brief Remembers which frames of a recording are already on disk, so that a recording that was interrupted, or whose queue only
+    changed towards its end, only renders the frames it is missing.
+
+    A recording is described as segments of consecutive frames (one per queue action), each with a hash of everything its frames
+    depend on: the hash of the segment before it (the first one starts from a hash of the data and the settings) and the action
+    itself.  A change in an action thus changes the hash of its segment and of all those after it, but not of those before.
+
+    The manifest is a text file in the folder of the stills: the segments, then one line per frame as it is saved, flushed right
+    away, so that it is up to date however the recording ends.  open() reads the manifests in the folder and keeps the frames
+    whose segment is still there with the same hash, and whose file exists; those are then skipped.  Processes recording different
+    ranges of frames into the same folder (see the batch mode's --jobs) each write their own manifest, and read each other's.
+*/
+class RecordingManifest
+{
+public:
+    struct Segment {
+        int first, count;
+        QByteArray hash;    // in hexadecimal
+    };
+
+    RecordingManifest();
+    ~RecordingManifest();
+    bool open(QString const& dir, std::vector<Segment> const& segments, int first, int last);
+    bool isOpen() const { return file != 0; }
+    bool done(int frame) const { return kept.count(frame) > 0; }
+    int keptFrames() const { return int(kept.size()); }
+    void markDone(int frame);
+    void close();
+
+private:
+    void readManifest(QString const& path, std::vector<Segment> const& segments, QDir const& dir);
+
+    FILE* file;
+    QMutex mutex;           // markDone() is called by FrameRecorder's workers
+    std::set<int> kept;     // frames already on disk, rendered the same way
+};
+
+#endif
@@ -0,0 +1,137 @@
+/*!
+ @file StaticOrbitLayer.cpp
+ @brief Implementation of StaticOrbitLayer, which keeps a set of fixed orbits in GPU buffers bucketed by frame window.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "StaticOrbitLayer.h"
+#include <algorithm>
+
+/*! @brief Orders orbits by frame window so that each bucket is contiguous.
+*/
+template<class T>
+static bool earlierWindow(T const& a, T const& b)
+{
+    return a.frameStart < b.frameStart || (a.frameStart == b.frameStart && a.frameEnd < b.frameEnd);
+}
+
+StaticOrbitLayer::StaticOrbitLayer()
+    : created(false)
+    , dirty(false)
+    , vertices(QOpenGLBuffer::VertexBuffer)
+    , indices(QOpenGLBuffer::IndexBuffer)
+    , indexCount(0)
+{}
+
+/*! @brief Removes every orbit from the layer.
+*/
+void StaticOrbitLayer::clear()
+{
+    orbits.clear();
+    buckets.clear();
+    active.clear();
+    indexCount = 0;
+    dirty = false;
+}
+
+/*! @brief Adds a closed ring of points, already in world coordinates, shown while the frame lies in [frameStart, frameEnd].
+*/
+void StaticOrbitLayer::addOrbit(std::vector<Point3d> const& ring, QColor const& color, int frameStart, int frameEnd)
+{
+    if (ring.size() < 2) return;
+    LayerOrbit orbit;
+    orbit.frameStart = frameStart;
+    orbit.frameEnd = frameEnd;
+    LineRenderer::appendPolyline(orbit.vertices, ring, color, true);
+    orbits.push_back(orbit);
+    dirty = true;
+}
+
+/*! @brief Sorts the orbits into frame-window buckets and uploads all their vertices in one buffer.
+*/
+void StaticOrbitLayer::upload()
+{
+    std::stable_sort(orbits.begin(), orbits.end(), earlierWindow<LayerOrbit>);
+
+    std::vector<GLfloat> data;
+    buckets.clear();
+    for (size_t i = 0; i < orbits.size(); ++i) {
+        if (buckets.empty() || buckets.back().frameStart != orbits[i].frameStart || buckets.back().frameEnd != orbits[i].frameEnd) {
+            Bucket b;
+            b.frameStart = orbits[i].frameStart;
+            b.frameEnd = orbits[i].frameEnd;
+            b.firstVertex = GLuint(data.size() / LineRenderer::floatsPerVertex);
+            b.segments = 0;
+            buckets.push_back(b);
+        }
+        buckets.back().segments += int(orbits[i].vertices.size() / (LineRenderer::floatsPerVertex * LineRenderer::verticesPerSegment));
+        data.insert(data.end(), orbits[i].vertices.begin(), orbits[i].vertices.end());
+    }
+
+    vertices.bind();
+    vertices.allocate(data.empty() ? 0 : &data[0], int(data.size() * sizeof(GLfloat)));
+    vertices.release();
+
+    active.assign(buckets.size(), false);
+    indexCount = 0;
+    dirty = false;
+}
+
+/*! @brief Draws the orbits whose frame window contains the given frame.
+*/
+void StaticOrbitLayer::draw(LineRenderer& lines, QMatrix4x4 const& mvp, QSize const& viewport, int frame)
+{
+    if (orbits.empty()) return;
+    if (!created) {
+        vertices.create();
+        indices.create();
+        created = true;
+    }
+    if (dirty) upload();
+
+    bool changed = false;
+    for (size_t b = 0; b < buckets.size(); ++b) {
+        bool on = buckets[b].frameStart <= frame && buckets[b].frameEnd >= frame;
+        if (on != active[b]) { active[b] = on; changed = true; }
+    }
+    if (changed) {
+        std::vector<GLuint> quads;
+        for (size_t b = 0; b < buckets.size(); ++b) {
+            if (active[b]) LineRenderer::appendIndices(quads, buckets[b].firstVertex, buckets[b].segments);
+        }
+        indexCount = int(quads.size());
+        indices.bind();
+        indices.allocate(quads.empty() ? 0 : &quads[0], int(quads.size() * sizeof(GLuint)));
+        indices.release();
+    }
+    lines.draw(vertices, indices, indexCount, mvp, viewport);
+}
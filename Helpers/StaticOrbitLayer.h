@@ -0,0 +1,93 @@
+/*!
+ @file StaticOrbitLayer.h
+ @brief Class definition for StaticOrbitLayer, which keeps a set of fixed orbits (e.g., the equatorial or ecliptic orbits) in GPU buffers.  It is used only by OrbitalAnimator.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef STATIC_ORBIT_LAYER_H
+#define STATIC_ORBIT_LAYER_H
+
+#include <vector>
+#include <QtGui/QOpenGLBuffer>
+#include <QtGui/QMatrix4x4>
+#include <QtGui/QColor>
+#include "Point3d.h"
+#include "LineRenderer.h"
+
+/*! @brief Draws a layer of orbits that never change, such as the ones read by OrbitalDataCSVReader, with one draw call.
+
+    The orbits are handed over once, already transformed into world coordinates, when the file is loaded.  They are grouped into
+    buckets of orbits sharing the same frame window [frameStart, frameEnd], and each bucket occupies one contiguous range of a
+    static vertex buffer.  Drawing a frame only has to find which buckets are active; the index buffer covering their rings is
+    rebuilt only when that set changes, so playback through a window costs a single glDrawElements per frame no matter
+    how many orbits the layer holds.  The rings are stored as LineRenderer segments, and drawn by it.
+
+    addOrbit() and clear() only touch CPU memory and can be called at any time.  draw() must be called with the widget's context
+    current (i.e., from paintGL()).
+*/
+class StaticOrbitLayer
+{
+public:
+    StaticOrbitLayer();
+    void clear();
+    void addOrbit(std::vector<Point3d> const& ring, QColor const& color, int frameStart, int frameEnd);
+    bool empty() const { return orbits.empty(); }
+    void draw(LineRenderer& lines, QMatrix4x4 const& mvp, QSize const& viewport, int frame);
+
+private:
+    /*! @brief One orbit of the layer, in world coordinates.
+    */
+    struct LayerOrbit {
+        int frameStart, frameEnd;
+        std::vector<GLfloat> vertices; // LineRenderer segments closing the ring
+    };
+    /*! @brief The orbits sharing one frame window, stored back to back in the vertex buffer.
+    */
+    struct Bucket {
+        int frameStart, frameEnd;
+        GLuint firstVertex;
+        int segments;
+    };
+
+    void upload();
+
+    bool created;
+    bool dirty;
+    QOpenGLBuffer vertices;
+    QOpenGLBuffer indices;
+    std::vector<LayerOrbit> orbits;
+    std::vector<Bucket> buckets;
+    std::vector<bool> active;          // which buckets the current index buffer covers
+    int indexCount;
+};
+
+#endif
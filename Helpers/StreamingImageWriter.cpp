@@ -0,0 +1,211 @@
+/*!
+ @file StreamingImageWriter.cpp
+ @brief Implementation of StreamingImageWriter, which writes an image to disk a strip of rows at a time.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "StreamingImageWriter.h"
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QDebug>
+#include <algorithm>
+
+#ifdef WIN32
+	#ifdef max
+	#undef max
+	#endif
+
+	#ifdef min
+	#undef min
+	#endif
+#endif
+
+/*! @brief The CRC-32 of PNG chunks (ISO 3309), continued from crc over n bytes of data.
+*/
+static unsigned int crc32(unsigned int crc, unsigned char const* data, size_t n)
+{
+    static unsigned int table[256];
+    static bool tableMade = false;
+    if (!tableMade) {
+        for (unsigned int i = 0; i < 256; ++i) {
+            unsigned int c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        tableMade = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+/*! @brief Appends value to bytes as four bytes, most significant first, as PNG and zlib want them.
+*/
+static void appendBigEndian(QByteArray& bytes, unsigned int value)
+{
+    bytes.append(char(value >> 24));
+    bytes.append(char(value >> 16));
+    bytes.append(char(value >> 8));
+    bytes.append(char(value));
+}
+
+StreamingImageWriter::StreamingImageWriter()
+    : file(0)
+    , png(true)
+    , failed(false)
+    , rowsWritten(0)
+    , adler(1)
+{
+}
+
+StreamingImageWriter::~StreamingImageWriter()
+{
+    close();
+}
+
+/*! @brief Creates the file for an image of the given size, and writes its header.
+*/
+bool StreamingImageWriter::open(QString const& path, QSize const& s)
+{
+    close();
+    size = s;
+    rowsWritten = 0;
+    adler = 1;
+    failed = false;
+    png = QFileInfo(path).suffix().toLower() != "ppm";
+    file = fopen(QFile::encodeName(path).constData(), "wb");
+    if (!file) {
+        qWarning() << "StreamingImageWriter: could not open" << path;
+        return false;
+    }
+    if (!png) {
+        failed = fprintf(file, "P6\n%d %d\n255\n", size.width(), size.height()) < 0;
+        return !failed;
+    }
+
+    static const char signature[] = { char(0x89), 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    QByteArray header;
+    appendBigEndian(header, size.width());
+    appendBigEndian(header, size.height());
+    header.append(char(8));     // bits per sample
+    header.append(char(2));     // RGB
+    header.append(char(0));     // deflate
+    header.append(char(0));     // adaptive filtering, of which we only use "none"
+    header.append(char(0));     // not interlaced
+    QByteArray zlibHeader;
+    zlibHeader.append(char(0x78));
+    zlibHeader.append(char(0x01));
+    failed = fwrite(signature, 1, sizeof(signature), file) != sizeof(signature)
+          || !writeChunk("IHDR", header) || !writeChunk("IDAT", zlibHeader);
+    return !failed;
+}
+
+/*! @brief Writes the rows of strip (which has the image's width) below those already written.  Rows past the image's height are left out.
+*/
+bool StreamingImageWriter::write(QImage const& strip)
+{
+    if (!file || failed) return false;
+    QImage rgb = strip.convertToFormat(QImage::Format_RGB888);
+    int w = size.width();
+    int rows = std::min(rgb.height(), size.height() - rowsWritten);
+    if (rgb.width() != w) return false;
+
+    if (!png) {
+        for (int y = 0; y < rows && !failed; ++y) failed = fwrite(rgb.constScanLine(y), 3, w, file) != size_t(w);
+        rowsWritten += rows;
+        return !failed;
+    }
+
+    // each row is a filter byte (0, none) and its pixels; the rows go in stored deflate blocks of at most 65535 bytes
+    QByteArray raw;
+    raw.reserve(rows * (3 * w + 1));
+    for (int y = 0; y < rows; ++y) {
+        raw.append(char(0));
+        raw.append(reinterpret_cast<char const*>(rgb.constScanLine(y)), 3 * w);
+    }
+    unsigned int a = adler & 0xFFFF, b = adler >> 16;
+    for (int i = 0; i < raw.size(); ++i) {
+        a = (a + (unsigned char)raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    adler = (b << 16) | a;
+
+    QByteArray deflate;
+    deflate.reserve(raw.size() + 5 * (raw.size() / 65535 + 1));
+    for (int at = 0; at < raw.size(); at += 65535) {
+        int n = std::min(65535, raw.size() - at);
+        unsigned int complement = ~unsigned(n) & 0xFFFF;
+        deflate.append(char(0));    // not the final block, stored
+        deflate.append(char(n & 0xFF));
+        deflate.append(char(n >> 8));
+        deflate.append(char(complement & 0xFF));
+        deflate.append(char(complement >> 8));
+        deflate.append(raw.constData() + at, n);
+    }
+    rowsWritten += rows;
+    failed = !writeChunk("IDAT", deflate);
+    return !failed;
+}
+
+/*! @brief Ends the image and closes the file.  Returns false if anything could not be written, or fewer rows than the image's height were.
+*/
+bool StreamingImageWriter::close()
+{
+    if (!file) return !failed;
+    if (rowsWritten != size.height()) failed = true;
+    if (png && !failed) {
+        QByteArray end;
+        end.append(char(1));        // the final block, stored and empty
+        end.append(char(0));
+        end.append(char(0));
+        end.append(char(0xFF));
+        end.append(char(0xFF));
+        appendBigEndian(end, adler);
+        failed = !writeChunk("IDAT", end) || !writeChunk("IEND", QByteArray());
+    }
+    failed = (fclose(file) != 0) || failed;
+    file = 0;
+    return !failed;
+}
+
+/*! @brief Writes one PNG chunk: its length, type, data and the CRC of the type and data.
+*/
+bool StreamingImageWriter::writeChunk(char const* type, QByteArray const& data)
+{
+    QByteArray chunk;
+    appendBigEndian(chunk, data.size());
+    chunk.append(type, 4);
+    chunk.append(data);
+    unsigned int crc = crc32(0, reinterpret_cast<unsigned char const*>(chunk.constData()) + 4, chunk.size() - 4);
+    appendBigEndian(chunk, crc);
+    return fwrite(chunk.constData(), 1, chunk.size(), file) == size_t(chunk.size());
+}
@@ -0,0 +1,73 @@
+/*!
+ @file StreamingImageWriter.h
+ @brief Class definition for StreamingImageWriter, which writes an image to disk a strip of rows at a time.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef STREAMING_IMAGE_WRITER_H
+#define STREAMING_IMAGE_WRITER_H
+
+#include <cstdio>
+#include <QtCore/QByteArray>
+#include <QtCore/QSize>
+#include <QtCore/QString>
+#include <QtGui/QImage>
+
+/*! @brief Writes an image too large to hold in memory (a 16K x 16K poster is 768 MB of RGB), one strip of rows after the other.
+
+    QImageWriter needs the whole image.  This writes the rows as they come, top to bottom, so that only the strip being written
+    is in memory.  The format follows from the file's suffix:
+    - .ppm, binary PPM (P6);
+    - anything else, PNG.  Without a deflate implementation of our own, its rows are stored in uncompressed deflate blocks: the
+      file is as large as the PPM, but any program reads it, and can recompress it (e.g., optipng).
+*/
+class StreamingImageWriter
+{
+public:
+    StreamingImageWriter();
+    ~StreamingImageWriter();
+    bool open(QString const& path, QSize const& size);
+    bool write(QImage const& strip);
+    bool close();
+
+private:
+    bool writeChunk(char const* type, QByteArray const& data);
+
+    FILE* file;
+    bool png;
+    bool failed;
+    QSize size;
+    int rowsWritten;
+    unsigned int adler;     // Adler-32 of the uncompressed PNG data so far
+};
+
+#endif
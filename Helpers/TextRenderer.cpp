@@ -0,0 +1,341 @@
+/*!
+ @file TextRenderer.cpp
+ @brief Implementation of TextRenderer, which draws overlay text and labels from a glyph atlas in a single batch.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "TextRenderer.h"
+#include "GLProfile.h"
+#include <QtCore/QDebug>
+#include <QtGui/QPainter>
+#include <QtGui/QFontMetrics>
+#include <QtGui/QVector2D>
+#include <algorithm>
+#include <cmath>
+
+#ifdef WIN32
+	#ifdef max
+	#undef max
+	#endif
+
+	#ifdef min
+	#undef min
+	#endif
+#endif
+
+static const int atlasWidth = 512;
+static const int maxAtlasHeight = 4096;
+static const int labelCellSize = 8;     // pixels per side of a declutter grid cell
+static const int labelOffset = 4;       // gap in pixels between a labelled point and its label
+
+static const char* textVertexShader =
+    "attribute vec2 position;\n"        // window pixels, origin at the top left
+    "attribute vec2 texCoord;\n"        // atlas pixels
+    "attribute vec4 color;\n"
+    "uniform vec2 viewport;\n"
+    "uniform vec2 atlasSize;\n"
+    "varying vec2 uv;\n"
+    "varying vec4 tint;\n"
+    "void main() {\n"
+    "    uv = texCoord / atlasSize;\n"
+    "    tint = color;\n"
+    "    gl_Position = vec4(2.0 * position.x / viewport.x - 1.0, 1.0 - 2.0 * position.y / viewport.y, 0.0, 1.0);\n"
+    "}\n";
+
+static const char* textFragmentShader =
+    "uniform sampler2D atlas;\n"
+    "varying vec2 uv;\n"
+    "varying vec4 tint;\n"
+    "void main() {\n"
+    "    gl_FragColor = vec4(tint.rgb, tint.a * texture2D(atlas, uv).a);\n"
+    "}\n";
+
+TextRenderer::TextRenderer()
+    : initialized(false)
+    , valid(false)
+    , vertices(QOpenGLBuffer::VertexBuffer)
+    , atlasTexture(0)
+    , atlasDirty(false)
+    , atlasFull(false)
+    , shelfX(0)
+    , shelfY(0)
+    , shelfHeight(0)
+    , width(1)
+    , height(1)
+    , gridColumns(0)
+    , gridRows(0)
+{
+    clearAtlas();
+}
+
+TextRenderer::~TextRenderer()
+{
+    if (atlasTexture) glDeleteTextures(1, &atlasTexture);
+}
+
+/*! @brief Compiles the shaders and creates the buffers.  Called by the first begin().
+*/
+void TextRenderer::initialize()
+{
+    initializeOpenGLFunctions();
+    initialized = true;
+    valid = program.addShaderFromSourceCode(QOpenGLShader::Vertex, GLProfile::vertexHeader() + textVertexShader)
+         && program.addShaderFromSourceCode(QOpenGLShader::Fragment, GLProfile::fragmentHeader() + textFragmentShader)
+         && program.link();
+    if (!valid) {
+        qWarning() << "TextRenderer: could not build shaders:" << program.log();
+        return;
+    }
+    vertices.create();
+    vertices.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    glGenTextures(1, &atlasTexture);
+    atlasDirty = true;
+}
+
+/*! @brief Empties the atlas and forgets every rasterized glyph.
+*/
+void TextRenderer::clearAtlas()
+{
+    atlas = QImage(atlasWidth, 256, QImage::Format_ARGB32_Premultiplied);
+    atlas.fill(Qt::transparent);
+    fonts.clear();
+    shelfX = shelfY = shelfHeight = 0;
+    atlasDirty = true;
+    atlasFull = false;
+}
+
+/*! @brief Starts a new frame: drops last frame's text and label placements.
+*/
+void TextRenderer::begin(int viewportWidth, int viewportHeight)
+{
+    if (!initialized) initialize();
+    if (atlasFull) clearAtlas();
+
+    width = std::max(viewportWidth, 1);
+    height = std::max(viewportHeight, 1);
+    batch.clear();
+    gridColumns = (width + labelCellSize - 1) / labelCellSize;
+    gridRows = (height + labelCellSize - 1) / labelCellSize;
+    occupied.assign(gridColumns * gridRows, false);
+}
+
+/*! @brief Returns the glyphs cached for a font, creating an empty set the first time the font is seen.
+*/
+TextRenderer::GlyphSet& TextRenderer::glyphSet(QFont const& font)
+{
+    QHash<QString, GlyphSet>::iterator itr = fonts.find(font.key());
+    if (itr == fonts.end()) {
+        QFontMetrics fm(font);
+        GlyphSet set;
+        set.ascent = fm.ascent();
+        set.lineHeight = fm.height();
+        itr = fonts.insert(font.key(), set);
+    }
+    return itr.value();
+}
+
+/*! @brief Returns a glyph, rasterizing it into the atlas if it is not there yet.
+
+    Glyphs are packed left to right on shelves as tall as the tallest glyph on them.  When the atlas runs out of room it doubles
+    in height, up to maxAtlasHeight.  Past that the glyph is drawn as blank and the atlas is emptied at the next begin().
+*/
+TextRenderer::Glyph const& TextRenderer::glyph(GlyphSet& set, QFont const& font, QChar c)
+{
+    QHash<ushort, Glyph>::const_iterator found = set.glyphs.constFind(c.unicode());
+    if (found != set.glyphs.constEnd()) return found.value();
+
+    QFontMetrics fm(font);
+    QRect bounds = fm.boundingRect(c);
+    Glyph g;
+    g.advance = fm.width(c);
+    g.left = bounds.left() - 1;
+    g.top = set.ascent + 1;
+    g.cell = QRect(0, 0, std::max(bounds.width(), 0) + 2, set.lineHeight + 2);
+    if (c.isSpace()) {
+        g.cell = QRect();
+        return set.glyphs.insert(c.unicode(), g).value();
+    }
+
+    if (shelfX + g.cell.width() > atlas.width()) {
+        shelfX = 0;
+        shelfY += shelfHeight;
+        shelfHeight = 0;
+    }
+    while (shelfY + g.cell.height() > atlas.height() && atlas.height() < maxAtlasHeight) {
+        QImage grown(atlas.width(), atlas.height() * 2, QImage::Format_ARGB32_Premultiplied);
+        grown.fill(Qt::transparent);
+        QPainter copy(&grown);
+        copy.drawImage(0, 0, atlas);
+        copy.end();
+        atlas = grown;
+    }
+    if (shelfY + g.cell.height() > atlas.height()) {
+        atlasFull = true;
+        g.cell = QRect();
+        return set.glyphs.insert(c.unicode(), g).value();
+    }
+
+    g.cell.moveTo(shelfX, shelfY);
+    shelfX += g.cell.width();
+    shelfHeight = std::max(shelfHeight, g.cell.height());
+
+    QPainter painter(&atlas);
+    painter.setFont(font);
+    painter.setPen(Qt::white);
+    painter.drawText(g.cell.left() - g.left, g.cell.top() + g.top, QString(c));
+    painter.end();
+    atlasDirty = true;
+
+    return set.glyphs.insert(c.unicode(), g).value();
+}
+
+/*! @brief Width in pixels of a line of text.
+*/
+int TextRenderer::textWidth(GlyphSet& set, QFont const& font, QString const& str)
+{
+    int w = 0;
+    for (int k = 0; k < str.size(); ++k) w += glyph(set, font, str[k]).advance;
+    return w;
+}
+
+/*! @brief Appends two triangles per glyph of a line of text to the batch.
+*/
+void TextRenderer::appendText(GlyphSet& set, QFont const& font, QString const& str, int x, int baseline, QColor const& color)
+{
+    GLfloat r = color.redF(), gr = color.greenF(), b = color.blueF(), a = color.alphaF();
+    for (int k = 0; k < str.size(); ++k) {
+        Glyph const& g = glyph(set, font, str[k]);
+        if (!g.cell.isNull()) {
+            GLfloat x0 = x + g.left, y0 = baseline - g.top;
+            GLfloat x1 = x0 + g.cell.width(), y1 = y0 + g.cell.height();
+            GLfloat s0 = g.cell.left(), t0 = g.cell.top();
+            GLfloat s1 = s0 + g.cell.width(), t1 = t0 + g.cell.height();
+            GLfloat quad[6][4] = { { x0, y0, s0, t0 }, { x1, y0, s1, t0 }, { x1, y1, s1, t1 },
+                                   { x0, y0, s0, t0 }, { x1, y1, s1, t1 }, { x0, y1, s0, t1 } };
+            for (int v = 0; v < 6; ++v) {
+                batch.insert(batch.end(), quad[v], quad[v] + 4);
+                batch.push_back(r);
+                batch.push_back(gr);
+                batch.push_back(b);
+                batch.push_back(a);
+            }
+        }
+        x += g.advance;
+    }
+}
+
+/*! @brief Queues a line of text whose baseline starts at the given window position (pixels, origin at the top left).
+*/
+void TextRenderer::addText(QString const& str, QPointF const& baseline, QFont const& font, QColor const& color)
+{
+    appendText(glyphSet(font), font, str, qRound(baseline.x()), qRound(baseline.y()), color);
+}
+
+/*! @brief Queues a label just to the right of a point in the window, unless it would overlap a label already placed this frame.
+
+    Returns whether the label was placed.
+*/
+bool TextRenderer::addLabel(QString const& str, QPointF const& anchor, QFont const& font, QColor const& color)
+{
+    GlyphSet& set = glyphSet(font);
+    int x = qRound(anchor.x()) + labelOffset;
+    int top = qRound(anchor.y()) - set.lineHeight / 2;
+    if (!claim(QRectF(x, top, textWidth(set, font, str), set.lineHeight))) return false;
+    appendText(set, font, str, x, top + set.ascent, color);
+    return true;
+}
+
+/*! @brief Marks the grid cells covered by a label rectangle, unless one of them is already taken.
+*/
+bool TextRenderer::claim(QRectF const& rect)
+{
+    int c0 = std::max(0, int(floor(rect.left() / labelCellSize)));
+    int c1 = std::min(gridColumns - 1, int(floor(rect.right() / labelCellSize)));
+    int r0 = std::max(0, int(floor(rect.top() / labelCellSize)));
+    int r1 = std::min(gridRows - 1, int(floor(rect.bottom() / labelCellSize)));
+    if (c0 > c1 || r0 > r1) return false;
+
+    for (int r = r0; r <= r1; ++r)
+        for (int c = c0; c <= c1; ++c)
+            if (occupied[r * gridColumns + c]) return false;
+    for (int r = r0; r <= r1; ++r)
+        for (int c = c0; c <= c1; ++c) occupied[r * gridColumns + c] = true;
+    return true;
+}
+
+/*! @brief Uploads the atlas if new glyphs were added, then draws all the queued text with one draw call.
+*/
+void TextRenderer::flush()
+{
+    if (!valid || batch.empty()) return;
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    if (atlasDirty) {
+        QImage rgba = atlas.convertToFormat(QImage::Format_RGBA8888);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, rgba.width(), rgba.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.constBits());
+        atlasDirty = false;
+    }
+
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+
+    program.bind();
+    program.setUniformValue("viewport", QVector2D(width, height));
+    program.setUniformValue("atlasSize", QVector2D(atlas.width(), atlas.height()));
+    program.setUniformValue("atlas", 0);
+
+    const int stride = 8 * sizeof(GLfloat);
+    vertices.bind();
+    vertices.allocate(&batch[0], int(batch.size() * sizeof(GLfloat)));
+    program.enableAttributeArray("position");
+    program.enableAttributeArray("texCoord");
+    program.enableAttributeArray("color");
+    program.setAttributeBuffer("position", GL_FLOAT, 0, 2, stride);
+    program.setAttributeBuffer("texCoord", GL_FLOAT, 2 * sizeof(GLfloat), 2, stride);
+    program.setAttributeBuffer("color", GL_FLOAT, 4 * sizeof(GLfloat), 4, stride);
+    glDrawArrays(GL_TRIANGLES, 0, GLsizei(batch.size() / 8));
+    program.disableAttributeArray("position");
+    program.disableAttributeArray("texCoord");
+    program.disableAttributeArray("color");
+    vertices.release();
+
+    program.release();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if (depthTest) glEnable(GL_DEPTH_TEST);
+    batch.clear();
+}
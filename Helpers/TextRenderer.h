@@ -0,0 +1,116 @@
+/*!
+ @file TextRenderer.h
+ @brief Class definition for TextRenderer, which draws overlay text and labels from a glyph atlas in a single batch.  It is used only by OrbitalAnimator.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef TEXT_RENDERER_H
+#define TEXT_RENDERER_H
+
+#include <vector>
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include <QtCore/QPointF>
+#include <QtCore/QRect>
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLShaderProgram>
+#include <QtGui/QOpenGLBuffer>
+#include <QtGui/QImage>
+#include <QtGui/QFont>
+#include <QtGui/QColor>
+
+/*! @brief Batches all the text drawn over the scene into one draw call.
+
+    Glyphs are rasterized once with QPainter into an atlas texture the first time a (font, character) pair is used.  Every
+    string added during a frame becomes a run of textured quads appended to a CPU-side vertex array, and flush() uploads that
+    array and draws it with a single glDrawArrays.  This replaces QGLWidget::renderText, which draws each string on its own and
+    stalls the pipeline while doing so.
+
+    Labels attached to points in the scene are decluttered in screen space: the window is split into a grid of cells, each label
+    claims the cells its rectangle covers, and a label touching an already claimed cell is dropped.  The test is conservative (a
+    label can be rejected by a neighbour whose cells touch but whose text does not), but it costs only a few lookups per label,
+    so thousands of labelled particles can be tested every frame.  Labels are placed first come, first served.
+
+    All functions that touch OpenGL must be called with the widget's context current (i.e., from paintGL()).
+*/
+class TextRenderer : protected QOpenGLFunctions
+{
+public:
+    TextRenderer();
+    ~TextRenderer();
+    void begin(int viewportWidth, int viewportHeight);
+    void addText(QString const& str, QPointF const& baseline, QFont const& font, QColor const& color);
+    bool addLabel(QString const& str, QPointF const& anchor, QFont const& font, QColor const& color);
+    void flush();
+
+private:
+    /*! @brief Location of a rasterized glyph in the atlas, and how to place it relative to the pen position.
+    */
+    struct Glyph {
+        QRect cell;     // pixels of the atlas holding the glyph (including a one pixel margin)
+        int left;       // offset from the pen position to the left edge of the cell
+        int top;        // offset from the baseline up to the top edge of the cell
+        int advance;    // distance to move the pen after the glyph
+    };
+    /*! @brief The glyphs rasterized so far for one font, with the metrics needed to lay out a line.
+    */
+    struct GlyphSet {
+        int ascent;
+        int lineHeight;
+        QHash<ushort, Glyph> glyphs;
+    };
+
+    void initialize();
+    GlyphSet& glyphSet(QFont const& font);
+    Glyph const& glyph(GlyphSet& set, QFont const& font, QChar c);
+    int textWidth(GlyphSet& set, QFont const& font, QString const& str);
+    void appendText(GlyphSet& set, QFont const& font, QString const& str, int x, int baseline, QColor const& color);
+    void clearAtlas();
+    bool claim(QRectF const& rect);
+
+    bool initialized;
+    bool valid;
+    QOpenGLShaderProgram program;
+    QOpenGLBuffer vertices;
+    GLuint atlasTexture;
+    QImage atlas;
+    bool atlasDirty;
+    bool atlasFull;
+    int shelfX, shelfY, shelfHeight; // next free position in the atlas, filled shelf by shelf
+    QHash<QString, GlyphSet> fonts;
+    std::vector<GLfloat> batch;       // x, y, s, t, r, g, b, a per vertex
+    int width, height;
+    int gridColumns, gridRows;
+    std::vector<bool> occupied;
+};
+
+#endif
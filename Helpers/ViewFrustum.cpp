@@ -0,0 +1,142 @@
+/*!
+ @file ViewFrustum.cpp
+ @brief Implementation of ViewFrustum, which decides whether objects are visible in the OrbitalAnimator's current view.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "ViewFrustum.h"
+#include <cmath>
+#include <algorithm>
+
+#ifdef WIN32
+	#ifdef max
+	#undef max
+	#endif
+
+	#ifdef min
+	#undef min
+	#endif
+#endif
+
+ViewFrustum::ViewFrustum()
+    : clipScale(1.)
+    , pixelScale(1.)
+    , viewAxis(0, 0, 1)
+    , width(1)
+    , height(1)
+{
+    for (int p = 0; p < 6; ++p)
+        for (int k = 0; k < 4; ++k) planes[p][k] = (k == 3) ? 1. : 0.;
+    for (int r = 0; r < 4; ++r)
+        for (int k = 0; k < 4; ++k) rows[r][k] = (r == k) ? 1. : 0.;
+}
+
+/*! @brief Rebuilds the clipping planes and pixel scale from the matrix that maps coordinates relative to origin to clip coordinates.
+
+    Each plane is a sum or difference of the fourth row of the matrix with one of the first three (Gribb & Hartmann), normalized
+    so that plane distances are in world units.
+*/
+void ViewFrustum::update(QMatrix4x4 const& mvp, int viewportWidth, int viewportHeight, Point3d const& origin)
+{
+    for (int r = 0; r < 4; ++r) {
+        for (int k = 0; k < 4; ++k) rows[r][k] = mvp(r, k);
+        rows[r][3] -= rows[r][0] * origin.x + rows[r][1] * origin.y + rows[r][2] * origin.z;
+    }
+
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int k = 0; k < 4; ++k) {
+            planes[2 * axis][k] = rows[3][k] + rows[axis][k];
+            planes[2 * axis + 1][k] = rows[3][k] - rows[axis][k];
+        }
+    }
+    for (int p = 0; p < 6; ++p) {
+        double n = sqrt(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+        if (n > 0) for (int k = 0; k < 4; ++k) planes[p][k] /= n;
+    }
+
+    double xScale = sqrt(rows[0][0] * rows[0][0] + rows[0][1] * rows[0][1] + rows[0][2] * rows[0][2]);
+    double yScale = sqrt(rows[1][0] * rows[1][0] + rows[1][1] * rows[1][1] + rows[1][2] * rows[1][2]);
+    clipScale = std::min(xScale, yScale);
+    pixelScale = std::max(xScale * viewportWidth / 2., yScale * viewportHeight / 2.);
+
+    viewAxis = toUnitVector(Point3d(rows[2][0], rows[2][1], rows[2][2]));
+    width = viewportWidth;
+    height = viewportHeight;
+}
+
+/*! @brief Maps a point in world coordinates to window coordinates (pixels, origin at the top left, as used by QPainter).
+
+    Returns false if the point falls outside the view, in which case window is left untouched.
+*/
+bool ViewFrustum::project(Point3d const& p, QPointF& window) const
+{
+    double clip[4];
+    for (int r = 0; r < 4; ++r) clip[r] = rows[r][0] * p.x + rows[r][1] * p.y + rows[r][2] * p.z + rows[r][3];
+    if (clip[3] <= 0) return false;
+    double x = clip[0] / clip[3], y = clip[1] / clip[3], z = clip[2] / clip[3];
+    if (x < -1 || x > 1 || y < -1 || y > 1 || z < -1 || z > 1) return false;
+    window = QPointF((x + 1) * width / 2., (1 - y) * height / 2.);
+    return true;
+}
+
+/*! @brief Classifies a bounding sphere given in world coordinates.
+*/
+Visibility ViewFrustum::classify(Point3d const& center, double radius) const
+{
+    for (int p = 0; p < 6; ++p) {
+        double d = planes[p][0] * center.x + planes[p][1] * center.y + planes[p][2] * center.z + planes[p][3];
+        if (d < -radius) return Outside;
+    }
+    if (2. * radius * pixelScale < 1.) return SubPixel;
+    return Visible;
+}
+
+/*! @brief Classifies an orbit from its focus, the unit normal to its plane, and its peri- and apoapsis distances.
+
+    Every point on the orbit lies within a(1+e) of the focus, which gives the bounding sphere used for the frustum and sub-pixel
+    tests.  Every point also lies at least a(1-e) from the focus, and once projected onto the screen that distance shrinks at most
+    by the cosine between the orbit normal and the line of sight.  When that projected inner radius clears the screen's
+    circumscribed circle, the orbit rings the view without ever entering it (common when zoomed deep into an inner system).
+*/
+Visibility ViewFrustum::classifyOrbit(Point3d const& focus, Point3d const& normal, double periapsis, double apoapsis) const
+{
+    Visibility v = classify(focus, apoapsis);
+    if (v != Visible) return v;
+
+    double cosView = fabs(dotProduct(normal, viewAxis));
+    double focusX = rows[0][0] * focus.x + rows[0][1] * focus.y + rows[0][2] * focus.z + rows[0][3];
+    double focusY = rows[1][0] * focus.x + rows[1][1] * focus.y + rows[1][2] * focus.z + rows[1][3];
+    double focusOffset = sqrt(focusX * focusX + focusY * focusY);
+    if (periapsis * cosView * clipScale - focusOffset > M_SQRT2) return Outside;
+
+    return Visible;
+}
@@ -0,0 +1,80 @@
+/*!
+ @file ViewFrustum.h
+ @brief Class definition for ViewFrustum, which decides whether objects are visible in the OrbitalAnimator's current view.  It is used only by OrbitalAnimator.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef VIEW_FRUSTUM_H
+#define VIEW_FRUSTUM_H
+
+#include <QtGui/QMatrix4x4>
+#include <QtCore/QPointF>
+#include "Point3d.h"
+
+/*! @brief Result of a visibility test against the view frustum.
+
+    "Outside" objects can be skipped entirely, "SubPixel" objects are smaller than a pixel on screen and can be collapsed
+    to a single point, and "Visible" objects have to be drawn in full.
+*/
+enum Visibility { Outside, SubPixel, Visible };
+
+/*! @brief Culls bounding spheres and orbits against the current view.
+
+    The frustum is rebuilt from the combined projection * modelview matrix at the start of every frame (see
+    Disp::OrbitalAnimator::paintGL()).  The six clipping planes are extracted directly from the rows of that matrix, and the
+    number of pixels per world unit is read off its scaling, so that objects can be classified as off-screen or sub-pixel
+    without drawing them.  The pixel estimate assumes an orthographic projection, which is what OrbitalAnimator::initializeGL() sets up.
+
+    The matrix may map coordinates relative to an origin rather than world coordinates (camera-relative rendering, see FramePreparer).
+    The translation to that origin is then folded into the rows in double precision, so the tests still take world coordinates and
+    stay exact far away from the central body.
+*/
+class ViewFrustum
+{
+public:
+    ViewFrustum();
+    void update(QMatrix4x4 const& mvp, int viewportWidth, int viewportHeight, Point3d const& origin = Point3d(0, 0, 0));
+    Visibility classify(Point3d const& center, double radius) const;
+    Visibility classifyOrbit(Point3d const& focus, Point3d const& normal, double periapsis, double apoapsis) const;
+    double pixelsPerUnit() const { return pixelScale; }
+    bool project(Point3d const& p, QPointF& window) const;
+
+private:
+    double planes[6][4];
+    double rows[4][4];
+    double clipScale;   // clip units per world unit (smallest of the x and y scalings)
+    double pixelScale;  // pixels per world unit (largest of the x and y scalings)
+    Point3d viewAxis;   // unit vector along the line of sight, in world coordinates
+    int width, height;  // viewport size in pixels
+};
+
+#endif
@@ -1,12 +1,17 @@
 TEMPLATE = app
 
-QT += core gui xml opengl
+QT += core gui xml opengl concurrent
 
 INCLUDEPATH += . ./OrbitalReaders ./OrbitalDisplays ./Eigen # ./ffmpeg /usr/local/lib
 
 #LIBS += -L/usr/local/lib -lavdevice -lavfilter -lavformat -lavcodec -lpostproc -lswresample -lswscale -lavutil
 #LIBS += -lz -lbz2 -liconv -lx264
 
+# CONFIG += core_profile draws in a QOpenGLWidget with an OpenGL 3.2 core-profile context instead of a legacy QGLWidget
+core_profile {
+    DEFINES += OGRE_CORE_PROFILE
+}
+
 DEPENDPATH += . ./OrbitalReaders ./OrbitalDisplays ./Eigen # ./ffmpeg
 
 include(OrbitalReaders/OrbitalReaders.pri)
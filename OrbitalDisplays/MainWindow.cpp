@@ -33,6 +33,8 @@
 */
 
 #include "MainWindow.h"
+#include <algorithm>
+#include <limits>
 
 namespace Disp {
 
@@ -297,6 +299,277 @@ namespace Disp {
         }
     }
 
+    /*!
+     * @brief Toggles the display for the particle trails.
+
+        Disabled if the simulation has not been loaded.
+        Called from the options menu in the menu bar. Options -> Show/Hide Particle Trails
+        Connected to the dispTrails action, which is connected to this function in RobD::MainWindow::makeConnections()
+        (see @ref sigslots).  Also see RobD::MainWindow::displayCentralBody() for an analogous description of the function body.
+     */
+    void MainWindow::displayTrails() {
+        if (trailsShowing) {
+            driver->animatorSettings.setDisplayTrails(false);
+            trailsShowing = false;
+            dispTrails->setText(tr("&Show Particle Trails"));
+        }
+        else {
+            driver->animatorSettings.setDisplayTrails(true);
+            trailsShowing = true;
+            dispTrails->setText(tr("&Hide Particle Trails"));
+        }
+    }
+
+    /*!
+     * @brief Toggles the display for the particle labels.
+
+        Disabled if the simulation has not been loaded.
+        Called from the options menu in the menu bar. Options -> Show/Hide Particle Labels
+        Connected to the dispLabels action, which is connected to this function in RobD::MainWindow::makeConnections()
+        (see @ref sigslots).  Also see RobD::MainWindow::displayCentralBody() for an analogous description of the function body.
+     */
+    void MainWindow::displayLabels() {
+        if (labelsShowing) {
+            driver->animatorSettings.setDisplayLabels(false);
+            labelsShowing = false;
+            dispLabels->setText(tr("&Show Particle Labels"));
+        }
+        else {
+            driver->animatorSettings.setDisplayLabels(true);
+            labelsShowing = true;
+            dispLabels->setText(tr("&Hide Particle Labels"));
+        }
+    }
+
+    /*!
+     * @brief Toggles the display of an arrow along the orbit normal of every particle.
+
+        Disabled if the simulation has not been loaded.
+        Called from the options menu in the menu bar. Options -> Show/Hide Orbit Normals
+        Connected to the dispNormals action.  Also see RobD::MainWindow::displayCentralBody() for an analogous description of the function body.
+     */
+    void MainWindow::displayNormals() {
+        if (normalsShowing) {
+            driver->animatorSettings.setDisplayNormals(false);
+            normalsShowing = false;
+            dispNormals->setText(tr("Show Orbit &Normals"));
+        }
+        else {
+            driver->animatorSettings.setDisplayNormals(true);
+            normalsShowing = true;
+            dispNormals->setText(tr("Hide Orbit &Normals"));
+        }
+    }
+
+    /*!
+     * @brief Toggles the display of an arrow along the velocity of every particle.
+
+        Disabled if the simulation has not been loaded.
+        Called from the options menu in the menu bar. Options -> Show/Hide Velocities
+        Connected to the dispVelocities action.  Also see RobD::MainWindow::displayCentralBody() for an analogous description of the function body.
+     */
+    void MainWindow::displayVelocities() {
+        if (velocitiesShowing) {
+            driver->animatorSettings.setDisplayVelocities(false);
+            velocitiesShowing = false;
+            dispVelocities->setText(tr("Show &Velocities"));
+        }
+        else {
+            driver->animatorSettings.setDisplayVelocities(true);
+            velocitiesShowing = true;
+            dispVelocities->setText(tr("Hide &Velocities"));
+        }
+    }
+
+    /*!
+     * @brief Toggles the long exposure of the particles' paths behind the free view.
+
+        Disabled if the simulation has not been loaded.
+        Called from the options menu in the menu bar. Options -> Start/Stop Long Exposure
+        While it is on, the frames played are added up, and the rest are added in the background (see LongExposure).  Stopping it
+        only hides the exposure: it is kept, and shown again when it is restarted, as long as the view has not changed.
+     */
+    void MainWindow::displayLongExposure() {
+        if (longExposureShowing) {
+            driver->animatorSettings.setLongExposure(false);
+            longExposureShowing = false;
+            dispLongExposure->setText(tr("Start Long &Exposure"));
+        }
+        else {
+            driver->animatorSettings.setLongExposure(true);
+            longExposureShowing = true;
+            dispLongExposure->setText(tr("Stop Long &Exposure"));
+        }
+    }
+
+    /*!
+     * @brief Splits the display into top, front, side and free views, or back to the free view alone.
+
+        Called from the options menu in the menu bar. Options -> Show Four Views, which is checkable and reflects the layout.
+        Every view is drawn from the same uploaded particles and orbits, so the extra views only cost their draw calls.
+     */
+    void MainWindow::displayFourViews() {
+        driver->animatorSettings.setViewLayout(fourViews->isChecked() ? OrbitalAnimatorSettings::QuadViews
+                                                                     : OrbitalAnimatorSettings::SingleView);
+    }
+
+    /*!
+     * @brief Colors the particles and orbits by the attribute chosen in Options -> Color Particles By.
+
+        Each action in the colorAttributes group carries a ColorAttribute (see Colormap.h) as its data.  The actions are exclusive and
+        checkable, so the menu always shows the current choice.  Connected to the triggered() signal of the group in
+        RobD::MainWindow::makeConnections() (see @ref sigslots).
+     */
+    void MainWindow::chooseColorAttribute(QAction* action) {
+        driver->animatorSettings.setColorAttribute(action->data().toInt());
+    }
+
+    /*!
+     * @brief Toggles whether the colormap spans the loaded values of the attribute, or the range chosen with chooseColorRange().
+
+        Called from the options menu in the menu bar. Options -> Automatic Color Range
+     */
+    void MainWindow::displayAutoColorRange() {
+        driver->animatorSettings.setColorRangeAuto(autoColorRange->isChecked());
+    }
+
+    /*!
+     * @brief Asks the user for the values of the attribute at the two ends of the colormap.
+
+        Called from the options menu in the menu bar. Options -> Set Color Range...
+        Turns off the automatic color range if both values are accepted.
+     */
+    void MainWindow::chooseColorRange() {
+        bool ok;
+        double min = QInputDialog::getDouble(this, tr("Color Range"), tr("Value at the start of the colormap:"),
+                                             driver->animatorSettings.colorRangeMin(), -1e300, 1e300, 6, &ok);
+        if (!ok) return;
+        double max = QInputDialog::getDouble(this, tr("Color Range"), tr("Value at the end of the colormap:"),
+                                             driver->animatorSettings.colorRangeMax(), -1e300, 1e300, 6, &ok);
+        if (!ok) return;
+        driver->animatorSettings.setColorRange(min, max);
+        autoColorRange->setChecked(false);
+    }
+
+    /*!
+     * @brief Asks the user for the ID of the particle to center the view on, or -1 for the central body.
+
+        Disabled if the simulation has not been loaded.
+        Called from the options menu in the menu bar. Options -> Center View On Particle...
+        The view then follows that particle, and its neighborhood stays sharp however far it is zoomed in (see PreparedFrame).
+     */
+    void MainWindow::chooseFocusParticle() {
+        bool ok;
+        int id = QInputDialog::getInt(this, tr("Center View"), tr("ID of the particle to center on (-1 for the central body):"),
+                                      driver->animatorSettings.focusParticle(), -1, std::numeric_limits<int>::max(), 1, &ok);
+        if (!ok) return;
+        driver->animatorSettings.setFocusParticle(id);
+    }
+
+    /*!
+     * @brief Asks the user for the size of a poster of the current view and where to save it, then saves it.
+
+        Disabled if the simulation has not been loaded.
+        Called from the file menu in the menu bar. File -> Save Poster...
+        The poster is rendered in tiles, so it can be larger than the graphics card could render at once (see OrbitalAnimator::renderPoster()).
+     */
+    void MainWindow::savePoster() {
+        bool ok;
+        QString text = QInputDialog::getText(this, tr("Save Poster"), tr("Size of the poster (WxH):"), QLineEdit::Normal, "8192x8192", &ok);
+        if (!ok) return;
+        QStringList dims = text.split('x');
+        bool wOk = false, hOk = false;
+        QSize size = dims.size() == 2 ? QSize(dims[0].trimmed().toInt(&wOk), dims[1].trimmed().toInt(&hOk)) : QSize();
+        if (!wOk || !hOk || size.isEmpty()) return;
+        QString fileName = QFileDialog::getSaveFileName(this, tr("Save Poster"), qgetenv("HOME"), tr("PNG (*.png);;PPM (*.ppm)"));
+        if (fileName.isEmpty()) return;
+        if (!driver->savePoster(fileName, size))
+            QMessageBox::warning(this, tr("Save Poster"), tr("The poster could not be written to %1.").arg(fileName));
+    }
+
+    /*!
+     * @brief Asks the user where to save the queue, and saves it with the simulation file loaded and the settings.
+
+        Called from the file menu in the menu bar. File -> Save Queue...
+        The file can be opened again with File -> Open Queue..., or rendered without the interface (see main.cpp), and renders
+        the same frames (see OrbitalAnimationDriver::saveQueue()).
+     */
+    void MainWindow::saveQueue() {
+        if (queue->rowCount() == 0) {
+            QMessageBox::warning(this, tr("Save Queue"), tr("The queue is empty."));
+            return;
+        }
+        QString fileName = QFileDialog::getSaveFileName(this, tr("Save Queue"), qgetenv("HOME"), tr("OGRE queue (*.xml)"));
+        if (fileName.isEmpty()) return;
+        if (!driver->saveQueue(fileName, queue))
+            QMessageBox::warning(this, tr("Save Queue"), tr("The queue could not be written to %1.").arg(fileName));
+    }
+
+    /*!
+     * @brief Asks the user for a queue saved by saveQueue(), and loads it with its settings and simulation file.
+
+        Called from the file menu in the menu bar. File -> Open Queue...
+        The simulation file is only loaded again if it is not the one already loaded.  If the file cannot be read, nothing changes.
+     */
+    void MainWindow::openQueue() {
+        QString fileName = QFileDialog::getOpenFileName(this, tr("Open Queue"), qgetenv("HOME"), tr("OGRE queue (*.xml);;All files (*)"));
+        if (fileName.isEmpty()) return;
+        if (driver->timelinePlayer().isPlaying()) stopPlayback();
+        SimulationSource source;
+        QueueStart start;
+        QString error;
+        if (!driver->loadQueue(fileName, queue, &source, &error, &start)) {
+            QMessageBox::warning(this, tr("Open Queue"), tr("The queue could not be read:\n%1").arg(error));
+            return;
+        }
+        if (!source.filename.isEmpty() && source.filename != driver->simulationSource().filename) {
+            if (QFileInfo(source.filename).exists())
+                openSimulation(source.filename, source.fileType, source.dataType, source.fullOrbit);
+            else
+                QMessageBox::warning(this, tr("Open Queue"), tr("The simulation file of the queue, %1, was not found.").arg(source.filename));
+        }
+        driver->showStart(start);
+        showSettings();
+    }
+
+    /*!
+     * @brief Asks the user for the size of the recorded frames (e.g., 1920x1080, or nothing for the size of the display) and
+        their number of samples per pixel.
+
+        Called from the options menu in the menu bar. Options -> Recording Size...
+        The frames are rendered offscreen at that size whatever the size of the window (see OrbitalAnimator::record()).
+     */
+    void MainWindow::chooseRecordSize() {
+        QSize size = driver->animatorSettings.recordSize();
+        bool ok;
+        QString text = QInputDialog::getText(this, tr("Recording Size"), tr("Size of the recorded frames (WxH, empty for the display's):"),
+                                             QLineEdit::Normal, size.isEmpty() ? QString() : QString("%1x%2").arg(size.width()).arg(size.height()), &ok);
+        if (!ok) return;
+        QStringList dims = text.split('x');
+        bool wOk = false, hOk = false;
+        if (dims.size() == 2) size = QSize(dims[0].trimmed().toInt(&wOk), dims[1].trimmed().toInt(&hOk));
+        if (!text.trimmed().isEmpty() && (!wOk || !hOk || size.isEmpty())) return;
+        int samples = QInputDialog::getInt(this, tr("Recording Size"), tr("Samples per pixel (0 for no multisampling):"),
+                                           driver->animatorSettings.recordSamples(), 0, 16, 1, &ok);
+        if (!ok) return;
+        driver->animatorSettings.setRecordSize(text.trimmed().isEmpty() ? QSize() : size);
+        driver->animatorSettings.setRecordSamples(samples);
+    }
+
+    /*!
+     * @brief Asks the user how much memory the frames kept for scrubbing may take, 0 to keep none.
+
+        Called from the options menu in the menu bar. Options -> Frame Cache Size...
+        Frames reached by moving the time slider are kept, and drawn again without rendering when the slider comes back to them
+        with the same view (see FrameCache).
+     */
+    void MainWindow::chooseFrameCacheSize() {
+        bool ok;
+        int megabytes = QInputDialog::getInt(this, tr("Frame Cache Size"), tr("Memory for the frames kept for scrubbing, in MB (0 for none):"),
+                                             driver->animatorSettings.frameCacheSize(), 0, 1 << 16, 64, &ok);
+        if (ok) driver->animatorSettings.setFrameCacheSize(megabytes);
+    }
+
     /*!
      * @brief Launches a dialog used for adding an action to the queue.
 
@@ -333,16 +606,74 @@ namespace Disp {
 
         @sa @ref RobD::OrbitalAnimationDriver::playbackQueue(), RobD::MainWindow::makeConnections()
     */
-    void MainWindow::playbackQueue() { driver->playbackQueue(queue); }
+    void MainWindow::playbackQueue() {
+        driver->playbackQueue(queue);
+        TimelinePlayer& player = driver->timelinePlayer();
+        timelineSlider->setRange(0, std::max(player.timeline().frames() - 1, 0));
+        timelineSlider->setEnabled(player.isPlaying());
+        pauseButton->setText(tr("Pause"));
+        pauseButton->setEnabled(player.isPlaying());
+        stopButton->setEnabled(player.isPlaying());
+    }
+
+    /*!
+     * @brief Pauses the playback of the queue, or resumes it if it is paused.
+
+        Called when the pauseButton is pressed.  While paused, the timelineSlider still moves the playback to any frame.
+     */
+    void MainWindow::pausePlayback() {
+        TimelinePlayer& player = driver->timelinePlayer();
+        if (player.isPaused()) {
+            player.resume();
+            pauseButton->setText(tr("Pause"));
+        }
+        else {
+            player.pause();
+            pauseButton->setText(tr("Resume"));
+        }
+    }
+
+    /*!
+     * @brief Stops the playback of the queue where it is.  Called when the stopButton is pressed.
+     */
+    void MainWindow::stopPlayback() {
+        driver->timelinePlayer().stop();
+        playbackFinished();
+    }
+
+    /*!
+     * @brief Disables the playback controls once the playback has ended, or was stopped.
+     */
+    void MainWindow::playbackFinished() {
+        pauseButton->setText(tr("Pause"));
+        pauseButton->setDisabled(true);
+        stopButton->setDisabled(true);
+        timelineSlider->setDisabled(true);
+    }
 
     /*! @brief Calls RobD::OrbitalAnimationDriver::record(), passing it the queue.
 
         Called when the recordButton is pressed.  Corresponds to the recordButton QPushButton defined in MainWindow.h, that is connected to this
-        function (SLOT) in RobD::MainWindow::MakeConnections() (see @ref sigslots).
+        function (SLOT) in RobD::MainWindow::MakeConnections() (see @ref sigslots).  A playback still running is stopped first, as
+        the recording takes over the display.
 
         @sa @ref RobD::OrbitalAnimationDriver::record(), RobD::MainWindow::makeConnections()
     */
-    void MainWindow::record() { driver->record(queue); }
+    void MainWindow::record() {
+        stopPlayback();
+        driver->record(queue);
+    }
+
+    /*! @brief Calls RobD::OrbitalAnimationDriver::recordMovie(), passing it the queue.
+
+        Called when the recordMovieButton is pressed, like RobD::MainWindow::record().
+
+        @sa @ref RobD::OrbitalAnimationDriver::recordMovie(), RobD::MainWindow::makeConnections()
+    */
+    void MainWindow::recordMovie() {
+        stopPlayback();
+        driver->recordMovie(queue);
+    }
 
     /*! @brief Initializes all of the actions to be put into the menu bar.
 
@@ -360,11 +691,31 @@ namespace Disp {
         removeEquatorialFile = new QAction(tr("&Remove Equatorial Orbits"), this);
         removeEclipticFile = new QAction(tr("&Remove Ecliptic Orbits"), this);
         removeAll = new QAction(tr("&Remove All Orbits"), this);
+        savePosterAction = new QAction(tr("Save &Poster..."), this);
+        saveQueueAction = new QAction(tr("Save &Queue..."), this);
+        openQueueAction = new QAction(tr("Open Q&ueue..."), this);
         dispCentralBody = new QAction(tr("&Hide Central Body"), this);
         centralBodyColor = new QAction(tr("&Change Central Body Color"), this);
         dispCoords = new QAction(tr("&Hide Coordinate Axes"), this);
         dispMainOrbit = new QAction(tr("&Hide Main Orbit"), this);
         dispSpinAxis = new QAction(tr("&Hide Spin Axis"), this);
+        dispTrails = new QAction(tr("&Show Particle Trails"), this);
+        dispLabels = new QAction(tr("&Show Particle Labels"), this);
+        dispNormals = new QAction(tr("Show Orbit &Normals"), this);
+        dispVelocities = new QAction(tr("Show &Velocities"), this);
+        dispLongExposure = new QAction(tr("Start Long &Exposure"), this);
+        colorAttributes = new QActionGroup(this);
+        for (int a = 0; a < ColorAttributeCount; ++a) {
+            QAction* action = colorAttributes->addAction(Colormap::attributeName(ColorAttribute(a)));
+            action->setCheckable(true);
+            action->setData(a);
+        }
+        autoColorRange = new QAction(tr("&Automatic Color Range"), this);
+        colorRange = new QAction(tr("Set Color &Range..."), this);
+        fourViews = new QAction(tr("Show &Four Views"), this);
+        focusParticle = new QAction(tr("Center View On &Particle..."), this);
+        recordSize = new QAction(tr("&Recording Size..."), this);
+        frameCacheSize = new QAction(tr("Frame &Cache Size..."), this);
         separator = new QAction(this);
     }
 
@@ -381,11 +732,23 @@ namespace Disp {
         removeEquatorialFile->setDisabled(true);
         removeEclipticFile->setDisabled(true);
         removeAll->setDisabled(true);
+        savePosterAction->setDisabled(true);
         dispCentralBody->setDisabled(true);
         centralBodyColor->setDisabled(true);
         dispCoords->setDisabled(true);
         dispMainOrbit->setDisabled(true);
         dispSpinAxis->setDisabled(true);
+        dispTrails->setDisabled(true);
+        dispLabels->setDisabled(true);
+        dispNormals->setDisabled(true);
+        dispVelocities->setDisabled(true);
+        dispLongExposure->setDisabled(true);
+        colorAttributes->actions()[driver->animatorSettings.colorAttribute()]->setChecked(true);
+        autoColorRange->setCheckable(true);
+        autoColorRange->setChecked(driver->animatorSettings.colorRangeAuto());
+        fourViews->setCheckable(true);
+        fourViews->setChecked(driver->animatorSettings.viewLayout() == OrbitalAnimatorSettings::QuadViews);
+        focusParticle->setDisabled(true);
         separator->setSeparator(true); // a horizontal line to be displayed in the file menu below the different open options
     }
 
@@ -404,12 +767,31 @@ namespace Disp {
         fileMenu->addAction(removeEquatorialFile);
         fileMenu->addAction(removeEclipticFile);
         fileMenu->addAction(removeAll);
+        fileMenu->addSeparator();
+        fileMenu->addAction(savePosterAction);
+        fileMenu->addSeparator();
+        fileMenu->addAction(openQueueAction);
+        fileMenu->addAction(saveQueueAction);
         optionsMenu = menuBar()->addMenu(tr("&Options"));
         optionsMenu->addAction(dispCentralBody);
         optionsMenu->addAction(centralBodyColor);
         optionsMenu->addAction(dispCoords);
         optionsMenu->addAction(dispMainOrbit);
         optionsMenu->addAction(dispSpinAxis);
+        optionsMenu->addAction(dispTrails);
+        optionsMenu->addAction(dispLabels);
+        optionsMenu->addAction(dispNormals);
+        optionsMenu->addAction(dispVelocities);
+        optionsMenu->addAction(dispLongExposure);
+        colorByMenu = optionsMenu->addMenu(tr("&Color Particles By"));
+        colorByMenu->addActions(colorAttributes->actions());
+        colorByMenu->addSeparator();
+        colorByMenu->addAction(autoColorRange);
+        colorByMenu->addAction(colorRange);
+        optionsMenu->addAction(fourViews);
+        optionsMenu->addAction(focusParticle);
+        optionsMenu->addAction(recordSize);
+        optionsMenu->addAction(frameCacheSize);
     }
 
     /*! @brief Initializes the actionSelectorButton (a QComboBox) that's used to add actions to the queue at the bottom.
@@ -439,6 +821,18 @@ namespace Disp {
         playbackButton->setMaximumWidth(80);
         recordButton = new QPushButton(tr("Record"), this);
         recordButton->setMaximumWidth(80);
+        recordMovieButton = new QPushButton(tr("Record Movie"), this);
+        recordMovieButton->setMaximumWidth(110);
+        pauseButton = new QPushButton(tr("Pause"), this);
+        pauseButton->setMaximumWidth(80);
+        pauseButton->setDisabled(true);
+        stopButton = new QPushButton(tr("Stop"), this);
+        stopButton->setMaximumWidth(80);
+        stopButton->setDisabled(true);
+        timelineSlider = new QSlider(Qt::Horizontal, this);
+        timelineSlider->setMinimumWidth(200);
+        timelineSlider->setRange(0, 0);
+        timelineSlider->setDisabled(true);
         setupActionSelector();
     }
 
@@ -455,7 +849,7 @@ namespace Disp {
         "actionSelectorLayout" is the layout for "actionSelector," and it is located at the right of
         "queueTitleLayout." It contains the "actionSelectorButton" and its label.
         "playbackButtonLayout" is the layout for "playback," and it is located at the bottom of "queueBoxLayout."
-        It contains "playbackButton" and the "recordButton."
+        It contains "timelineSlider," "recordButton," "recordMovieButton," "playbackButton," "pauseButton" and "stopButton."
 
         See MainWindow::setupUIElements()
     */
@@ -502,7 +896,7 @@ namespace Disp {
         and the QComboBox "actionSelector." It is shown above the QTableWidget "queue." The layout for
         "queueBoxLower" is queueLayout, and it just contains the QTableWidget "queue." It is just a wrapper.
         Finally, the layout for "playback" is "playbackButtonLayout." It is a horizontal layout that contains the
-        two buttons "recordButton" and "playbackButton."
+        "timelineSlider," which follows and moves the playback, and the buttons to record, play, pause and stop the queue.
 
         @sa MainWindow::createUIElements()
     */
@@ -542,8 +936,12 @@ namespace Disp {
         queueTitleLayout->setMargin(0);
         queueBoxUpper->setLayout(queueTitleLayout);
 
+        playbackButtonLayout->addWidget(timelineSlider);
         playbackButtonLayout->addWidget(recordButton);
+        playbackButtonLayout->addWidget(recordMovieButton);
         playbackButtonLayout->addWidget(playbackButton);
+        playbackButtonLayout->addWidget(pauseButton);
+        playbackButtonLayout->addWidget(stopButton);
         playbackButtonLayout->setAlignment(Qt::AlignRight);
         playbackButtonLayout->setMargin(5);
         playback->setLayout(playbackButtonLayout);
@@ -578,16 +976,37 @@ namespace Disp {
         connect(removeEquatorialFile, SIGNAL(triggered()), this, SLOT(removeEquatorial()));
         connect(removeEclipticFile, SIGNAL(triggered()), this, SLOT(removeEcliptic()));
         connect(removeAll, SIGNAL(triggered()), this, SLOT(removeAllOrbits()));
+        connect(savePosterAction, SIGNAL(triggered()), this, SLOT(savePoster()));
+        connect(saveQueueAction, SIGNAL(triggered()), this, SLOT(saveQueue()));
+        connect(openQueueAction, SIGNAL(triggered()), this, SLOT(openQueue()));
         connect(dispCentralBody, SIGNAL(triggered()), this, SLOT(displayCentralBody()));
         connect(centralBodyColor, SIGNAL(triggered()), this, SLOT(chooseCentralBodyColor()));
         connect(dispCoords, SIGNAL(triggered()), this, SLOT(displayCoords()));
         connect(dispMainOrbit, SIGNAL(triggered()), this, SLOT(displayMainOrbit()));
         connect(dispSpinAxis, SIGNAL(triggered()), this, SLOT(displaySpinAxis()));
+        connect(dispTrails, SIGNAL(triggered()), this, SLOT(displayTrails()));
+        connect(dispLabels, SIGNAL(triggered()), this, SLOT(displayLabels()));
+        connect(dispNormals, SIGNAL(triggered()), this, SLOT(displayNormals()));
+        connect(dispVelocities, SIGNAL(triggered()), this, SLOT(displayVelocities()));
+        connect(dispLongExposure, SIGNAL(triggered()), this, SLOT(displayLongExposure()));
+        connect(colorAttributes, SIGNAL(triggered(QAction*)), this, SLOT(chooseColorAttribute(QAction*)));
+        connect(autoColorRange, SIGNAL(triggered()), this, SLOT(displayAutoColorRange()));
+        connect(colorRange, SIGNAL(triggered()), this, SLOT(chooseColorRange()));
+        connect(fourViews, SIGNAL(triggered()), this, SLOT(displayFourViews()));
+        connect(focusParticle, SIGNAL(triggered()), this, SLOT(chooseFocusParticle()));
+        connect(recordSize, SIGNAL(triggered()), this, SLOT(chooseRecordSize()));
+        connect(frameCacheSize, SIGNAL(triggered()), this, SLOT(chooseFrameCacheSize()));
         /*connect(queue, SIGNAL(itemDoubleClicked(QTableWidgetItem*)),
                 driver, SLOT(performAction(QTableWidgetItem*)));*/
         connect(queue, SIGNAL(customContextMenuRequested(QPoint)), queue, SLOT(provideContextMenu(QPoint)));
         connect(playbackButton, SIGNAL(clicked()), this, SLOT(playbackQueue()));
+        connect(pauseButton, SIGNAL(clicked()), this, SLOT(pausePlayback()));
+        connect(stopButton, SIGNAL(clicked()), this, SLOT(stopPlayback()));
+        connect(timelineSlider, SIGNAL(sliderMoved(int)), &driver->timelinePlayer(), SLOT(seek(int)));
+        connect(&driver->timelinePlayer(), SIGNAL(frameReached(int)), timelineSlider, SLOT(setValue(int)));
+        connect(&driver->timelinePlayer(), SIGNAL(finished()), this, SLOT(playbackFinished()));
         connect(recordButton, SIGNAL(clicked()), this, SLOT(record()));
+        connect(recordMovieButton, SIGNAL(clicked()), this, SLOT(recordMovie()));
         connect(actionSelectorButton, SIGNAL(activated(int)), this, SLOT(launchAddActionDialog()));
     }
 
@@ -602,14 +1021,56 @@ namespace Disp {
         dispCoords->setEnabled(true);
         dispMainOrbit->setEnabled(true);
         dispSpinAxis->setEnabled(true);
+        dispTrails->setEnabled(true);
+        dispLabels->setEnabled(true);
+        dispNormals->setEnabled(true);
+        dispVelocities->setEnabled(true);
+        dispLongExposure->setEnabled(true);
+        focusParticle->setEnabled(true);
+        savePosterAction->setEnabled(true);
         centralBodyShowing = true;
         coordsShowing = true;
         mainOrbitShowing = true;
         spinAxisShowing = true;
+        trailsShowing = driver->animatorSettings.displayTrails();
+        labelsShowing = driver->animatorSettings.displayLabels();
+        normalsShowing = driver->animatorSettings.displayNormals();
+        velocitiesShowing = driver->animatorSettings.displayVelocities();
+        longExposureShowing = driver->animatorSettings.longExposure();
         removeSimulationFile->setEnabled(true);
         removeAll->setEnabled(true);
     }
 
+    /*! @brief Makes the menus show the settings, after they were changed other than from the menus.
+
+        Called by RobD::MainWindow::openQueue() once the settings saved with the queue are loaded: the show/hide items and their
+        booleans follow what is displayed, and the checkable items are checked as the settings are.
+      */
+    void MainWindow::showSettings() {
+        OrbitalAnimatorSettings& settings = driver->animatorSettings;
+        centralBodyShowing = settings.displayCentralBody();
+        coordsShowing = settings.displayCoords();
+        mainOrbitShowing = settings.displayMainOrbit();
+        spinAxisShowing = settings.displaySpinAxis();
+        trailsShowing = settings.displayTrails();
+        labelsShowing = settings.displayLabels();
+        normalsShowing = settings.displayNormals();
+        velocitiesShowing = settings.displayVelocities();
+        longExposureShowing = settings.longExposure();
+        dispCentralBody->setText(centralBodyShowing ? tr("&Hide Central Body") : tr("&Show Central Body"));
+        dispCoords->setText(coordsShowing ? tr("&Hide Coordinate Axes") : tr("&Show Coordinate Axes"));
+        dispMainOrbit->setText(mainOrbitShowing ? tr("&Hide Main Orbit") : tr("&Show Main Orbit"));
+        dispSpinAxis->setText(spinAxisShowing ? tr("&Hide Spin Axis") : tr("&Show Spin Axis"));
+        dispTrails->setText(trailsShowing ? tr("&Hide Particle Trails") : tr("&Show Particle Trails"));
+        dispLabels->setText(labelsShowing ? tr("&Hide Particle Labels") : tr("&Show Particle Labels"));
+        dispNormals->setText(normalsShowing ? tr("Hide Orbit &Normals") : tr("Show Orbit &Normals"));
+        dispVelocities->setText(velocitiesShowing ? tr("Hide &Velocities") : tr("Show &Velocities"));
+        dispLongExposure->setText(longExposureShowing ? tr("Stop Long &Exposure") : tr("Start Long &Exposure"));
+        colorAttributes->actions()[settings.colorAttribute()]->setChecked(true);
+        autoColorRange->setChecked(settings.colorRangeAuto());
+        fourViews->setChecked(settings.viewLayout() == OrbitalAnimatorSettings::QuadViews);
+    }
+
 
     /*! @brief Called when an equatorial file is loaded.
 
@@ -649,6 +1110,14 @@ namespace Disp {
         dispCoords->setDisabled(true);
         dispMainOrbit->setDisabled(true);
         dispSpinAxis->setDisabled(true);
+        dispTrails->setDisabled(true);
+        dispLabels->setDisabled(true);
+        dispNormals->setDisabled(true);
+        dispVelocities->setDisabled(true);
+        dispLongExposure->setDisabled(true);
+        focusParticle->setDisabled(true);
+        savePosterAction->setDisabled(true);
+        driver->animatorSettings.setFocusParticle(-1);
         if (!removeEquatorialFile->isEnabled() && !removeEclipticFile->isEnabled()) {
             removeAll->setDisabled(true);
             dispCentralBody->setDisabled(true);
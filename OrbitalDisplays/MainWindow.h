@@ -39,10 +39,13 @@
 #include <QMainWindow>
 #include <QMenu>
 #include <QAction>
+#include <QActionGroup>
+#include <QInputDialog>
 #include <QComboBox>
 #include <QLabel>
 #include <QFileDialog>
 #include <QTextEdit>
+#include <QMessageBox>
 #include "OrbitalAnimationDriver.h"
 #include "QueueActionDialog.h"
 #include "Queue.h"
@@ -83,9 +86,28 @@ namespace Disp
         void displayCoords();
         void displayMainOrbit();
         void displaySpinAxis();
+        void displayTrails();
+        void displayLabels();
+        void displayNormals();
+        void displayVelocities();
+        void displayLongExposure();
+        void chooseColorAttribute(QAction* action);
+        void displayAutoColorRange();
+        void chooseColorRange();
+        void displayFourViews();
+        void chooseFocusParticle();
+        void chooseRecordSize();
+        void chooseFrameCacheSize();
+        void savePoster();
+        void saveQueue();
+        void openQueue();
         void launchAddActionDialog();
         void playbackQueue();
+        void pausePlayback();
+        void stopPlayback();
+        void playbackFinished();
         void record();
+        void recordMovie();
 
     private:
         void createMenuOptions();
@@ -103,20 +125,39 @@ namespace Disp
         void simulationRemoved();
         void equatorialRemoved();
         void eclipticRemoved();
+        void showSettings();
 
         QMenu* fileMenu;
         QMenu* optionsMenu;
+        QMenu* colorByMenu;
 
         QAction* dispCentralBody;
         QAction* centralBodyColor;
         QAction* dispCoords;
         QAction* dispMainOrbit;
         QAction* dispSpinAxis;
+        QAction* dispTrails;
+        QAction* dispLabels;
+        QAction* dispNormals;
+        QAction* dispVelocities;
+        QAction* dispLongExposure;
+        QActionGroup* colorAttributes;
+        QAction* autoColorRange;
+        QAction* colorRange;
+        QAction* fourViews;
+        QAction* focusParticle;
+        QAction* recordSize;
+        QAction* frameCacheSize;
 
         bool centralBodyShowing;
         bool coordsShowing;
         bool mainOrbitShowing;
         bool spinAxisShowing;
+        bool trailsShowing;
+        bool labelsShowing;
+        bool normalsShowing;
+        bool velocitiesShowing;
+        bool longExposureShowing;
 
         QAction* openSimulationFile;
         QAction* openEclipticFile;
@@ -126,11 +167,18 @@ namespace Disp
         QAction* removeEquatorialFile;
         QAction* removeEclipticFile;
         QAction* removeAll;
+        QAction* savePosterAction;
+        QAction* saveQueueAction;
+        QAction* openQueueAction;
 
         Queue* queue;
         QComboBox* actionSelectorButton;
         QPushButton* playbackButton;
         QPushButton* recordButton;
+        QPushButton* recordMovieButton;
+        QPushButton* pauseButton;
+        QPushButton* stopButton;
+        QSlider* timelineSlider;
 
         OrbitalAnimationDriver* driver;
         QWidget* settingsDialog;
@@ -111,6 +111,8 @@ namespace Disp
         }
         orbitalAnimator->simulationDataLoaded = true;
         orbitalAnimator->updateGL();
+        SimulationSource source = { QFileInfo(filename).absoluteFilePath(), fileType, dataType, b };
+        simulation = source;
     }
 
     /*! @brief Called by Disp::MainWindow simply to pass the command onto Disp::OrbitalAnimator or Disp::SettingsDialog.
@@ -122,7 +124,7 @@ namespace Disp
 
         @sa
     */
-    void OrbitalAnimationDriver::clearSimulationData() { orbitalAnimator->clearSimulationData(); }
+    void OrbitalAnimationDriver::clearSimulationData() { orbitalAnimator->clearSimulationData(); simulation.filename.clear(); }
     /*! @brief Called by Disp::MainWindow simply to pass the command onto Disp::OrbitalAnimator or Disp::SettingsDialog.
 
         @sa
@@ -132,12 +134,110 @@ namespace Disp
 
         @sa
     */
-    void OrbitalAnimationDriver::clearAllData() { orbitalAnimator->clearAllData(); }
+    void OrbitalAnimationDriver::clearAllData() { orbitalAnimator->clearAllData(); simulation.filename.clear(); }
     /*! @brief Called by Disp::MainWindow simply to pass the command onto Disp::OrbitalAnimator or Disp::SettingsDialog.
 
         @sa
     */
     void OrbitalAnimationDriver::playbackQueue(QTableWidget* queue) { orbitalAnimator->playbackQueue(queue); }
+    /*! @brief Returns the player of playbackQueue(), to pause, move or stop the playback and follow its progress.
+
+        @sa Disp::TimelinePlayer
+    */
+    TimelinePlayer& OrbitalAnimationDriver::timelinePlayer() { return orbitalAnimator->timelinePlayer(); }
+    /*! @brief Saves queue to an XML file at path, with the simulation file loaded and the settings, so that loadQueue() (or the
+        command-line batch mode, see main.cpp) renders the same frames from it.
+
+        The file is an <ogre> document (see Queue::newDocument()) holding, in order:
+        - <simulation file="..." fileType="..." dataType="..." fullOrbit="..."/>, if a simulation is loaded; the file is saved
+          with its absolute path, and may be given relative to the queue file's folder when written by hand;
+        - <start xrot="..." yrot="..." zrot="..." scale="..." frame="..." fullOrbit="..." fillOrbits="..."/>, the camera and
+          orbit display the queue starts from, which its actions do not all set;
+        - <settings .../>, see OrbitalAnimatorSettings::toXml();
+        - <queue>, see Queue::toXml().
+        Returns false if the file cannot be written.
+    */
+    bool OrbitalAnimationDriver::saveQueue(QString const& path, Queue* queue) const {
+        QDomDocument document = Queue::newDocument();
+        QDomElement root = document.documentElement();
+        if (!simulation.filename.isEmpty()) {
+            QDomElement source = document.createElement("simulation");
+            source.setAttribute("file", simulation.filename);
+            source.setAttribute("fileType", simulation.fileType);
+            source.setAttribute("dataType", simulation.dataType);
+            source.setAttribute("fullOrbit", simulation.fullOrbit);
+            root.appendChild(source);
+        }
+        CameraState camera = orbitalAnimator->cameraState();
+        QDomElement start = document.createElement("start");
+        start.setAttribute("xrot", camera.xrot);
+        start.setAttribute("yrot", camera.yrot);
+        start.setAttribute("zrot", camera.zrot);
+        start.setAttribute("scale", camera.scale);
+        start.setAttribute("frame", camera.frame);
+        start.setAttribute("fullOrbit", orbitalAnimator->getFullOrbit());
+        start.setAttribute("fillOrbits", orbitalAnimator->getFillOrbits());
+        root.appendChild(start);
+        root.appendChild(animatorSettings.toXml(document));
+        root.appendChild(queue->toXml(document));
+        return Queue::writeDocument(document, path);
+    }
+    /*! @brief Loads the queue, and the settings if there are any, saved by saveQueue() (or by Queue::save()) at path.
+
+        The simulation file is not loaded: if source is given, it is set to the one saved (with an empty filename if there is
+        none), for the caller to load it if it is not already.  Likewise, if start is given, it is set to the state the queue
+        starts from, for the caller to pass to showStart() once the simulation is loaded (which resets the orbit display).  On failure nothing is changed and, if error is given, it is set
+        to a description of the problem.
+    */
+    bool OrbitalAnimationDriver::loadQueue(QString const& path, Queue* queue, SimulationSource* source, QString* error, QueueStart* start) {
+        QDomDocument document;
+        if (!Queue::readDocument(path, document, error)) return false;
+        QDomElement root = document.documentElement();
+        QDomElement queueElement = root.firstChildElement("queue");
+        if (queueElement.isNull()) {
+            if (error) *error = QString("%1: not an OGRE queue file").arg(path);
+            return false;
+        }
+        // check the settings before changing anything, so that a file that cannot be read leaves everything as it was
+        QDomElement settings = root.firstChildElement("settings");
+        OrbitalAnimatorSettings check;
+        QString message;
+        if ((!settings.isNull() && !check.fromXml(settings, &message)) || !queue->fromXml(queueElement, &message)) {
+            if (error) *error = path + ": " + message;
+            return false;
+        }
+        if (!settings.isNull()) animatorSettings.fromXml(settings);
+
+        if (source) {
+            QDomElement e = root.firstChildElement("simulation");
+            source->filename = e.isNull() || e.attribute("file").isEmpty()
+                    ? QString() : QFileInfo(QFileInfo(path).absoluteDir(), e.attribute("file")).absoluteFilePath();
+            source->fileType = e.attribute("fileType", "Rebound");
+            source->dataType = e.attribute("dataType");
+            source->fullOrbit = e.attribute("fullOrbit", "0") != "0";
+        }
+        if (start) {
+            QDomElement e = root.firstChildElement("start");
+            start->saved = !e.isNull();
+            start->camera.xrot = e.attribute("xrot", "0").toDouble();
+            start->camera.yrot = e.attribute("yrot", "0").toDouble();
+            start->camera.zrot = e.attribute("zrot", "0").toDouble();
+            start->camera.scale = e.attribute("scale", "1").toDouble();
+            start->camera.frame = e.attribute("frame", "0").toInt();
+            start->fullOrbit = e.attribute("fullOrbit", "0") != "0";
+            start->fillOrbits = e.attribute("fillOrbits", "0") != "0";
+        }
+        return true;
+    }
+    /*! @brief Shows the state a queue starts from, as read by loadQueue().  Does nothing if the queue file had none.
+    */
+    void OrbitalAnimationDriver::showStart(QueueStart const& start) {
+        if (!start.saved) return;
+        orbitalAnimator->setFullOrbit(start.fullOrbit);
+        orbitalAnimator->setFillOrbits(start.fillOrbits);
+        orbitalAnimator->showState(start.camera);
+        orbitalAnimator->requestRedraw();
+    }
     /*! @brief Called by Disp::MainWindow simply to pass the command onto Disp::OrbitalAnimator or Disp::SettingsDialog.
 
         @sa
@@ -147,6 +247,33 @@ namespace Disp
 
         @sa
     */
+    void OrbitalAnimationDriver::recordMovie(QTableWidget* queue) { orbitalAnimator->recordMovie(queue); }
+    /*! @brief Records frames first to last - 1 of the queue into output (a folder, or a movie file) without asking.  Used by the
+        command-line batch mode.
+
+        Returns false if the output could not be written.
+        @sa Disp::OrbitalAnimator::record()
+    */
+    bool OrbitalAnimationDriver::record(QTableWidget* queue, QString const& output, int first, int last) { return orbitalAnimator->record(queue, output, first, last); }
+    /*! @brief Makes the Disp::OrbitalAnimator render offscreen at the given size, so the driver can record without being shown.
+
+        Must be called after setupUI() and before any data is loaded.  Returns false if no OpenGL context could be created.
+        @sa Disp::OrbitalAnimator::startHeadless()
+    */
+    bool OrbitalAnimationDriver::startHeadless(QSize const& size) { return orbitalAnimator->startHeadless(size); }
+    /*! @brief Saves a poster of the given size in path, of the current state or, if queue is given, of the state the queue ends in.
+
+        Returns false if it could not be written.
+        @sa Disp::OrbitalAnimator::renderPoster()
+    */
+    bool OrbitalAnimationDriver::savePoster(QString const& path, QSize const& size, QTableWidget* queue) {
+        if (queue) orbitalAnimator->playThrough(queue);
+        return orbitalAnimator->renderPoster(path, size);
+    }
+    /*! @brief Called by Disp::MainWindow simply to pass the command onto Disp::OrbitalAnimator or Disp::SettingsDialog.
+
+        @sa
+    */
     void OrbitalAnimationDriver::setViewableArea(int w, int h) { orbitalAnimator->resize(w, h); }
     /*! @brief Called by Disp::MainWindow simply to pass the command onto Disp::OrbitalAnimator or Disp::SettingsDialog.
 
@@ -190,6 +317,7 @@ namespace Disp
     void OrbitalAnimationDriver::makeConnections()
     {
         connect(orbitalAnimator->settingsDialog, SIGNAL(setCurrentIndex(int)), orbitalAnimator, SLOT(setCurrentIndex(int)));
+        connect(orbitalAnimator->settingsDialog, SIGNAL(timeScrubbed()), orbitalAnimator, SLOT(timeScrubbed()));
         connect(orbitalAnimator->settingsDialog, SIGNAL(setXRot(double)), orbitalAnimator, SLOT(setXRot(double)));
         connect(orbitalAnimator->settingsDialog, SIGNAL(setYRot(double)), orbitalAnimator, SLOT(setYRot(double)));
         connect(orbitalAnimator->settingsDialog, SIGNAL(setZRot(double)), orbitalAnimator, SLOT(setZRot(double)));
@@ -38,6 +38,7 @@
 
 #include <QtGui/QWidget>
 
+#include <QtCore/QFileInfo>
 #include <QtCore/QTimer>
 
 #include "OrbitalAnimator.h"
@@ -64,6 +65,24 @@ namespace Disp
 {
     class OrbitalAnimator;
     class SliderSpinBoxPair; // should be removed
+
+    /*! @brief The simulation file loaded, and how it was read (see Disp::OrbitalAnimationDriver::setSimulationData()).
+    */
+    struct SimulationSource
+    {
+        QString filename, fileType, dataType;
+        bool fullOrbit;
+    };
+
+    /*! @brief The camera and orbit display a saved queue was recorded from (see Disp::OrbitalAnimationDriver::saveQueue()).
+    */
+    struct QueueStart
+    {
+        bool saved;         // false if the file has none (written by Queue::save() or by hand)
+        CameraState camera;
+        bool fullOrbit, fillOrbits;
+    };
+
     /*!
         @brief Acts as a go-between for Disp::MainWindow and Disp::OrbitalAnimator that displays the orbits.
 
@@ -98,7 +117,16 @@ namespace Disp
         void clearSimulationData();
         void clearAllData();
         void playbackQueue(QTableWidget* queue);
+        TimelinePlayer& timelinePlayer();
+        bool saveQueue(QString const& path, Queue* queue) const;
+        bool loadQueue(QString const& path, Queue* queue, SimulationSource* source = 0, QString* error = 0, QueueStart* start = 0);
+        void showStart(QueueStart const& start);
+        SimulationSource const& simulationSource() const { return simulation; }
         void record(QTableWidget* queue);
+        void recordMovie(QTableWidget* queue);
+        bool record(QTableWidget* queue, QString const& output, int first = 0, int last = -1);
+        bool startHeadless(QSize const& size);
+        bool savePoster(QString const& path, QSize const& size, QTableWidget* queue = 0);
         std::vector<double> getState();
         int getSimulationSize();
 
@@ -115,6 +143,7 @@ namespace Disp
         OrbitalAnimator* orbitalAnimator;
         QWidget* controlsWidget;
         QTimer animationTimer;
+        SimulationSource simulation;    // empty filename if no simulation is loaded
     };
 } // namespace RobD
 
@@ -34,6 +34,7 @@
 
 #include "OrbitalAnimator.h"
 #include <qDebug>
+#include <cmath>
 
 #define COORD_X 0
 #define COORD_Y 1
@@ -50,7 +51,7 @@ namespace Disp
         The constructor initializes default values and prepares the arrays cosfs and sinfs.
     */
     OrbitalAnimator::OrbitalAnimator(OrbitalAnimatorSettings& settings_, QWidget *parent)
-        : QGLWidget(parent)
+        : AnimatorWidget(parent)
         , simulationDataLoaded(false)
         , equatorialDataLoaded(false)
         , eclipticDataLoaded(false)
@@ -61,16 +62,29 @@ namespace Disp
         , xrotation(0.)
         , yrotation(20.)
         , zrotation(-15.)
-        , centralBody(20, 20, 0)
+        , allRingsVisible(true)
+        , allPlanesVisible(true)
+        , orbitsCollapsed(false)
         , loading(false)
         , recording(false)
+        , offscreenContext(0)
+        , offscreenSurface(0)
         , pictureNumber(0)
-        , trailLength(60)
+        , recordFirst(0)
+        , recordLast(-1)
+        , tiling(false)
+        , timeMoved(false)
+        , trails(60)
         , drawFullOrbit(false)
         , fillOrbits(false)
         , drawParticles(true)
-        , drawOrbitNormals(false)
+        , densityMode(false)
     {
+        for (int a = 0; a < ColorAttributeCount; ++a) {
+            attributeMin[a] = 0;
+            attributeMax[a] = 1;
+        }
+
         QFont newFont(font());
         newFont.setPointSize(30);
         setFont(newFont);
@@ -81,8 +95,12 @@ namespace Disp
         eqRotAngles = angularMapping(zEq, xEq);
 
         prepfs();
+        activeView = layoutViews().back();
         setMouseTracking(true);
-        connect(&settings, SIGNAL(changed()), this, SLOT(updateGL()));
+        connect(&settings, SIGNAL(changed()), this, SLOT(requestRedraw()));
+        connect(&scheduler, SIGNAL(render()), this, SLOT(updateGL()));
+        connect(&player, SIGNAL(frameReached(int)), this, SLOT(showTimelineFrame(int)));
+        if (QGuiApplication::primaryScreen()) scheduler.setRefreshRate(QGuiApplication::primaryScreen()->refreshRate());
 
         //orbitalAnimator->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding); // Expanding fills up as much space as available
 
@@ -91,6 +109,45 @@ namespace Disp
         setSizePolicy(spol); // this is for setting fixed aspect ratio */
     }
 
+    OrbitalAnimator::~OrbitalAnimator()
+    {
+        makeRenderContextCurrent();
+    }
+
+    /*! @brief Renders into an offscreen surface from now on, so that record() works without the widget ever being shown.
+
+        Used by the command-line batch mode.  The context has the application's default format, and the platform plugin
+        decides what backs it: "offscreen" or "minimalegl" with Mesa's surfaceless EGL on nodes without a display.
+        The widget is fixed to size, which is the size of the saved images.  Returns false if no context could be made.
+    */
+    bool OrbitalAnimator::startHeadless(QSize const& size)
+    {
+        offscreenContext = new QOpenGLContext(this);
+        offscreenContext->setFormat(QSurfaceFormat::defaultFormat());
+        offscreenSurface = new QOffscreenSurface;
+        offscreenSurface->setParent(this);      // destroyed after the renderers, which release their resources with it current
+        offscreenSurface->setFormat(QSurfaceFormat::defaultFormat());
+        offscreenSurface->create();
+        if (!offscreenContext->create() || !offscreenSurface->isValid() || !offscreenContext->makeCurrent(offscreenSurface)) {
+            qWarning("OrbitalAnimator: could not create an offscreen OpenGL context");
+            return false;
+        }
+
+        setAttribute(Qt::WA_DontShowOnScreen);
+        setFixedSize(size);
+        initializeGL();
+        resizeGL(size.width(), size.height());
+        return true;
+    }
+
+    /*! @brief Makes the offscreen context current if startHeadless() made one, and the widget's own otherwise.
+    */
+    void OrbitalAnimator::makeRenderContextCurrent()
+    {
+        if (offscreenContext) offscreenContext->makeCurrent(offscreenSurface);
+        else makeCurrent();
+    }
+
     int OrbitalAnimator::heightForWidth(int width) const
     {
         return width;
@@ -127,11 +184,13 @@ namespace Disp
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         glEnable(GL_BLEND);
 
-        glMatrixMode(GL_PROJECTION);
-        glLoadIdentity();
-        glOrtho(-0.5, +0.5, -0.5, +0.5, 1.0, 40.0);
-        glMatrixMode(GL_MODELVIEW);
-        gluLookAt(0, 0, 30, 0, 0, 0, 0, 1, 0);
+        // The projection (glOrtho(-0.5, +0.5, -0.5, +0.5, 1.0, 40.0) looking from (0, 0, 30)) is part of viewProjection(),
+        // which the renderers take as a uniform.  A core-profile context also needs a vertex array object bound to draw;
+        // one is kept bound for the lifetime of the context.
+        if (GLProfile::core()) {
+            vertexArray.create();
+            vertexArray.bind();
+        }
 
         /*GLfloat values[2];
         glGetFloatv (GL_LINE_WIDTH_GRANULARITY, values);
@@ -139,9 +198,8 @@ namespace Disp
         glGetFloatv (GL_LINE_WIDTH_RANGE, values);
         qDebug() << "GL_LINE_WIDTH_RANGE values are " << values[0] << "and" << values[1];*/
 
-        glEnable(GL_LINE_SMOOTH);      
-        glHint(GL_LINE_SMOOTH_HINT, GL_DONT_CARE);
-        glLineWidth(8.5);
+        // Wide lines are drawn as antialiased quads by Disp::OrbitalAnimator::lines (see LineRenderer), rather than
+        // with GL_LINE_SMOOTH and glLineWidth, which many drivers clamp or rasterize slowly.
     }
 
     /*! @brief Resizes the OpenGL viewport
@@ -159,7 +217,8 @@ namespace Disp
 
     /*! @brief Renders the scene
 
-        This function is called everytime updateGL() is called, and is where everything in the OrbitalAnimator is drawn.  For a description of the various
+        This function is called everytime updateGL() is called (interactive changes go through requestRedraw(), which calls it at most
+        once per display refresh), and is where everything in the OrbitalAnimator is drawn.  For a description of the various
         functions used and an overview of openGL, see @ref opengl.
 
         The scale is determined by the first file loaded (whether it be a simulation file, equatorial file, or
@@ -168,81 +227,57 @@ namespace Disp
         file, and then taking the inverse.  See @ref othergl for more details on how the scale is set.
     */
     void OrbitalAnimator::paintGL() {
-        glPushMatrix();
+        scheduler.frameRendered();
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-        double orbitXScaleFactor = maximum.x - minimum.x;
-        double orbitYScaleFactor = maximum.y - minimum.y;
-        double orbitZScaleFactor = maximum.z - minimum.z;
-        double maxscale = std::max(orbitXScaleFactor, std::max(orbitYScaleFactor, orbitZScaleFactor));
-        double orbitScaleFactor = ((maxscale == 0) ? 1. : 1./maxscale);
-        glScalef(scaleFactor * orbitScaleFactor, scaleFactor * orbitScaleFactor, scaleFactor * orbitScaleFactor);
-        glRotatef(-90, 1, 0, 0); // Change x-y orbital plane to x-z Display plane for display
-        glRotatef(-90, 0, 0, 1);
-        glRotatef(xrotation, 1, 0, 0);
-        glRotatef(yrotation, 0, 1, 0);
-        glRotatef(zrotation, 0, 0, 1);
-
-        if (settings.displayCoords() && simulationDataLoaded) drawCoords(coordLength);
-
-        glPushMatrix();
-        glColor4f(settings.centralBodyColor().red() / 255.,
-                  settings.centralBodyColor().green() / 255.,
-                  settings.centralBodyColor().blue() / 255.,
-                  settings.centralBodyColor().alpha() / 255.);
-        if (settings.displayCentralBody()) {
-            centralBody.updateRadius(0.02 * coordLength);
-            centralBody.draw();
+        QSize size = renderSize();
+
+        // A frame shown before with the same camera and settings (e.g., when scrubbing the time slider back over it) is redrawn
+        // from frameCache.  Recordings, posters and long exposures always render.
+        frameCache.setBudget(qint64(settings.frameCacheSize()) << 20);
+        bool cacheable = frameCache.enabled() && !recordTarget && !loading && !settings.longExposure();
+        QByteArray key = cacheable ? frameKey() : QByteArray();
+        bool keep = cacheable && timeMoved;
+        timeMoved = false;
+        if (cacheable && frameCache.draw(key, size)) return;
+
+        text.begin(size.width(), size.height());
+        lines.setWidth(settings.lineWidth());
+        updateColormap();
+
+        // The frame is uploaded once, then drawn from the same buffers in every view
+        bool showFrame = settings.displayMainOrbit() && simulationDataLoaded;
+        PreparedFrame const* frame = 0;
+        if (showFrame) {
+            bool glyphs = settings.displayNormals() || settings.displayVelocities();
+            frame = &preparer.acquire(currentIndex, colormap.attribute(), settings.focusParticle(), drawFullOrbit, fillOrbits, glyphs);
+            if (drawParticles) particles.upload(frame->particles);
+            if (drawFullOrbit) lines.upload(frame->rings);
+            if (drawFullOrbit && fillOrbits) planes.upload(frame->planes, frame->planeIndices);
+            if (glyphs) arrows.upload(frame->glyphs);
         }
-        glPopMatrix();
-
-        for (size_t i = 0; i < equatorialOrbits.size(); ++i) {
-            if (equatorialOrbits[i].frameStart <= currentIndex && equatorialOrbits[i].frameEnd >= currentIndex) {
-                glPushMatrix();
-                glRotatef(radsToDeg(eqRotAngles.phi), 0, 0, 1); // now do the three rotations to line up the axes
-                glRotatef(radsToDeg(eqRotAngles.theta), 0, 1, 0);
-                glRotatef(radsToDeg(eqRotAngles.psi), 0, 0, 1);
-                glRotatef(equatorialOrbits[i].Omega, 0, 0, 1);
-                glRotatef(equatorialOrbits[i].i, 1, 0, 0);
-                glRotatef(equatorialOrbits[i].w, 0, 0, 1);
-                glColor4f(equatorialOrbits[i].red / 255.,
-                          equatorialOrbits[i].green / 255.,
-                          equatorialOrbits[i].blue / 255.,
-                          1.);
-                drawOrbitalRing(equatorialOrbits[i].orbitCoords);
-                glPopMatrix();
+        // Camera-relative rendering: the prepared vertices are relative to origin (see PreparedFrame), and so is viewProjection()
+        origin = frame ? frame->origin : focusPosition();
+
+        std::vector<View> views = layoutViews();
+        if (frame && settings.longExposure()) updateExposure(*frame, views.back());
+        for (size_t v = 0; v < views.size(); ++v) {
+            activeView = views[v];
+            QRect const& rect = activeView.rect;
+            glViewport(rect.x(), size.height() - rect.y() - rect.height(), rect.width(), rect.height());
+            // Everything is drawn with the explicit viewProjection() (or worldProjection()) matrix, not the fixed-function stack
+            frustum.update(viewProjection(), rect.width(), rect.height(), origin);
+            drawView(frame);
+            if (views.size() > 1) {     // never when tiling (see layoutViews())
+                QFont nameFont;
+                nameFont.setPointSize(10);
+                text.addText(activeView.name, QPointF(rect.x() + 5, rect.y() + 15), nameFont, settings.labelColor());
             }
         }
+        glViewport(0, 0, size.width(), size.height());
+        activeView = views.back();
 
-        for (size_t i = 0; i < eclipticOrbits.size(); ++i) {
-            if (eclipticOrbits[i].frameStart <= currentIndex && eclipticOrbits[i].frameEnd >= currentIndex) {
-                glPushMatrix();
-                glRotatef(eclipticOrbits[i].Omega, 0, 0, 1);
-                glRotatef(eclipticOrbits[i].i, 1, 0, 0);
-                glRotatef(eclipticOrbits[i].w, 0, 0, 1);
-                glColor4f(eclipticOrbits[i].red / 255.,
-                          eclipticOrbits[i].green / 255.,
-                          eclipticOrbits[i].blue / 255.,
-                          1.);
-                drawOrbitalRing(eclipticOrbits[i].orbitCoords);
-                glPopMatrix();
-            }
-        }
-
-        if (settings.displayMainOrbit() && simulationDataLoaded) {
-            glPushMatrix();
-            if (drawFullOrbit) {
-                drawOrbit();
-            }
-            if (drawParticles) {
-                drawParticle();
-            }
-            if (drawOrbitNormals) {
-                drawOrbitalNormal();
-            }
-            glPopMatrix();
-            drawTime<OpenGL>();
-        }
+        if (showFrame && !tiling) drawTime<OpenGL>();
 /*
         if(settings.displaySpinAxis() && simulationDataLoaded)
         {
@@ -258,57 +293,368 @@ namespace Disp
         //drawYZPlane(coordLength);
         //drawXYPlane(coordLength);
 
-        if (loading) drawLoading<OpenGL>();
-        if (!recording) drawStats<OpenGL>();
+        if (loading && !tiling) drawLoading<OpenGL>();
+        if (!recording && !tiling) drawStats<OpenGL>();
+        text.flush();
+        if (keep) frameCache.store(key, size);
+    }
+
+    /*! @brief Draws the scene in the current view (see activeView), with frame the prepared particles and orbits, or 0 if they are hidden.
+
+        The particles, rings and planes of frame were uploaded by paintGL(), so each view only costs its draw calls.
+    */
+    void OrbitalAnimator::drawView(PreparedFrame const* frame) {
+        if (settings.displayCoords() && simulationDataLoaded) drawAxes();
+
+        if (settings.displayCentralBody()) {
+            std::vector<GLfloat> center = centralBody();
+            particles.drawDisc(QVector3D(center[0], center[1], center[2]), viewProjection(), 2. * 0.02 * coordLength, viewSize(),
+                               settings.centralBodyColor());
+        }
+
+        equatorialLayer.draw(lines, worldProjection(), viewSize(), currentIndex);
+        eclipticLayer.draw(lines, worldProjection(), viewSize(), currentIndex);
 
-        glPopMatrix();
+        if (!frame) return;
+        if (settings.displayTrails()) {
+            drawTrail();
+        }
+        cullOrbits(*frame);
+        if (settings.longExposure() && activeView.free) {
+            density.drawExposure(settings.densityExposure());
+        }
+        if (drawFullOrbit) {
+            drawOrbit();
+        }
+        if (drawParticles) {
+            if (useDensity()) drawDensity();
+            else drawParticle(*frame);
+        }
+        if (settings.displayNormals() || settings.displayVelocities()) {
+            drawGlyphs(*frame);
+        }
+        if (drawFullOrbit && fillOrbits) {
+            drawOrbitalPlanes();
+        }
+        if (settings.displayLabels()) {
+            drawLabels();
+        }
     }
 
-    /*! @brief Draws a trail behind the particle
+    /*! @brief Returns the views the widget is split into, as chosen by OrbitalAnimatorSettings::viewLayout().
 
-        This function currently does not work correctly and is not being called.
-        Right now, this function draws the trail of the first particle in the XY plane.
+        The single layout is the free view alone.  The quad layout adds views from the top (down the z axis), the front and the side
+        in a 2x2 grid, with the free view, which follows the mouse and the rotations set in the SettingsDialog, in the bottom right.
+        All views share the zoom (scaleFactor).  The four views have the same size, so that the framebuffers of the renderers that
+        draw through one of the view's size (OrbitalPlaneRenderer, DensityRenderer) are not made again for each view; with an odd
+        width or height, the last column or row of pixels is left as the background.
     */
-    void OrbitalAnimator::drawTrail() {
-        glPushMatrix();
-        glBegin(GL_LINE_STRIP);
-        glColor4f(0.8, 0.4, 0.0, 1.0);
-        OrbitData::const_iterator itr = orbitData.begin();
-        for (int i = currentIndex < trailLength ? 0 : currentIndex - trailLength; i < currentIndex; i++) {
-            glVertex3f((itr->second)[i].posInPlane.x,
-                       (itr->second)[i].posInPlane.y,
-                       (itr->second)[i].posInPlane.z);
+    std::vector<OrbitalAnimator::View> OrbitalAnimator::layoutViews() const {
+        std::vector<View> views;
+        QSize size = renderSize();
+        View free = { QRect(QPoint(0, 0), size), 0., 0., 0., tr("Free"), true };
+        if (settings.viewLayout() != OrbitalAnimatorSettings::QuadViews || tiling) {
+            views.push_back(free);
+            return views;
+        }
+        int w = size.width() / 2, h = size.height() / 2;
+        View top = { QRect(0, 0, w, h), 0., 90., 0., tr("Top"), false };
+        View front = { QRect(w, 0, w, h), 0., 0., 90., tr("Front"), false };
+        View side = { QRect(0, h, w, h), 0., 0., 0., tr("Side"), false };
+        free.rect = QRect(w, h, w, h);
+        views.push_back(top);
+        views.push_back(front);
+        views.push_back(side);
+        views.push_back(free);
+        return views;
+    }
+
+    /*! @brief Returns the size in pixels of what paintGL() draws into: the recording target while recording, the widget otherwise.
+    */
+    QSize OrbitalAnimator::renderSize() const {
+        return recordTarget ? recordTarget->size() : size();
+    }
+
+    /*! @brief Returns what the frame paintGL() draws depends on, apart from the data (frameCache is cleared when it changes): the
+        frame number, the camera, the size, what is drawn and the settings.
+    */
+    QByteArray OrbitalAnimator::frameKey() const {
+        QByteArray key;
+        QDataStream out(&key, QIODevice::WriteOnly);
+        out << currentIndex << xrotation << yrotation << zrotation << scaleFactor << size() << drawFullOrbit << fillOrbits
+            << drawParticles << simulationDataLoaded << equatorialDataLoaded << eclipticDataLoaded << settings.hash();
+        return key;
+    }
+
+    /*! @brief Returns the size in pixels of the view being drawn.
+    */
+    QSize OrbitalAnimator::viewSize() const {
+        return activeView.rect.size();
+    }
+
+    /*! @brief Returns the position of the particle the view is centered on (OrbitalAnimatorSettings::focusParticle()) at the current
+        frame, or the origin if the view is centered on the central body.
+    */
+    Point3d OrbitalAnimator::focusPosition() const {
+        OrbitData::const_iterator itr = orbitData.find(settings.focusParticle());
+        if (itr == orbitData.end() || (size_t)currentIndex >= (itr->second).size()) return Point3d(0, 0, 0);
+        return (itr->second)[currentIndex].position();
+    }
+
+    /*! @brief Returns the central body as one particle for ParticleRenderer, relative to origin.
+    */
+    std::vector<GLfloat> OrbitalAnimator::centralBody() const {
+        std::vector<GLfloat> center(ParticleRenderer::floatsPerParticle, 0.f);
+        center[0] = -origin.x;
+        center[1] = -origin.y;
+        center[2] = -origin.z;
+        return center;
+    }
+
+    /*! @brief Returns viewProjection() for geometry given in world coordinates, i.e., with the translation to origin applied.
+
+        The translation is done in float on the GPU, so this is only for what is not prepared relative to origin: the static orbit
+        layers and the particle trails.  These are precise at the scale of the central body's
+        system, not when zoomed in far from it.
+    */
+    QMatrix4x4 OrbitalAnimator::worldProjection() const {
+        QMatrix4x4 m = viewProjection();
+        m.translate(-origin.x, -origin.y, -origin.z);
+        return m;
+    }
+
+
+    /*! @brief Returns the factor that scales the loaded data to fit the display.
+
+        The scale is the inverse of the largest extent (max - min) of the data along x, y or z.  See @ref othergl.
+    */
+    double OrbitalAnimator::orbitScaleFactor() const {
+        double orbitXScaleFactor = maximum.x - minimum.x;
+        double orbitYScaleFactor = maximum.y - minimum.y;
+        double orbitZScaleFactor = maximum.z - minimum.z;
+        double maxscale = std::max(orbitXScaleFactor, std::max(orbitYScaleFactor, orbitZScaleFactor));
+        return ((maxscale == 0) ? 1. : 1./maxscale);
+    }
+
+    /*! @brief Returns the matrix mapping coordinates relative to origin to clip coordinates for the view being drawn (see activeView).
+
+        It has no translation, so float vertices near the camera keep their precision at any zoom (see PreparedFrame); use
+        worldProjection() for vertices in world coordinates.
+
+        This mirrors the projection set in initializeGL() and the modelview transformations applied at the top of paintGL(),
+        so that the CPU side (e.g., the culling done with Disp::OrbitalAnimator::frustum) sees exactly what OpenGL draws.
+    */
+    QMatrix4x4 OrbitalAnimator::viewProjection() const {
+        QMatrix4x4 m = tileTransform;   // the identity, except for the tiles of renderPoster()
+        m.ortho(-0.5, +0.5, -0.5, +0.5, 1.0, 40.0);
+        m.lookAt(QVector3D(0, 0, 30), QVector3D(0, 0, 0), QVector3D(0, 1, 0));
+        m.scale(scaleFactor * orbitScaleFactor());
+        m.rotate(-90, 1, 0, 0);
+        m.rotate(-90, 0, 0, 1);
+        m.rotate(activeView.free ? xrotation : activeView.xrot, 1, 0, 0);
+        m.rotate(activeView.free ? yrotation : activeView.yrot, 0, 1, 0);
+        m.rotate(activeView.free ? zrotation : activeView.zrot, 0, 0, 1);
+        return m;
+    }
+
+    /*! @brief Rotates a vector from the equatorial frame into the reference frame using eqRotAngles.
+
+        Same three rotations (phi about z, theta about y, psi about z) as the glRotatef calls that line up the equatorial axes.
+    */
+    Point3d OrbitalAnimator::equatorialToReference(Point3d const& p) const {
+        double cps = cos(eqRotAngles.psi), sps = sin(eqRotAngles.psi);
+        double cth = cos(eqRotAngles.theta), sth = sin(eqRotAngles.theta);
+        double cph = cos(eqRotAngles.phi), sph = sin(eqRotAngles.phi);
+
+        double x1 = p.x * cps - p.y * sps;
+        double y1 = p.x * sps + p.y * cps;
+        double x2 = x1 * cth + p.z * sth;
+        double z2 = -x1 * sth + p.z * cth;
+        return Point3d(x2 * cph - y1 * sph, x2 * sph + y1 * cph, z2);
+    }
+
+    /*! @brief Transforms the equatorial or ecliptic orbits into world coordinates and hands them to a StaticOrbitLayer.
+
+        The Omega, i, w rotations (and, for equatorial orbits, the eqRotAngles rotations) are applied here once, when the file is
+        loaded, instead of with glRotatef on every frame.  Called from updateEquatorialCache() and updateEclipticCache().
+    */
+    void OrbitalAnimator::buildStaticLayer(StaticOrbitLayer& layer, StaticDisplayOrbits const& orbits, bool equatorial) {
+        layer.clear();
+        std::vector<Point3d> ring;
+        for (size_t i = 0; i < orbits.size(); ++i) {
+            ring.resize(orbits[i].orbitCoords.size());
+            for (size_t f = 0; f < ring.size(); ++f) {
+                ring[f] = orbits[i].toReferenceFrame(orbits[i].orbitCoords[f]);
+                if (equatorial) ring[f] = equatorialToReference(ring[f]);
+            }
+            layer.addOrbit(ring, QColor(orbits[i].red, orbits[i].green, orbits[i].blue), orbits[i].frameStart, orbits[i].frameEnd);
         }
-        glEnd();
-        glPopMatrix();
+    }
+
+    /*! @brief Draws a trail behind every particle
+
+        The recent positions of all particles are kept on the GPU by ParticleTrails, so each new frame only uploads
+        one set of positions and all trails are drawn in a single call, fading out with age.
+        Called from paintGL() when OrbitalAnimatorSettings::displayTrails() is set.
+    */
+    void OrbitalAnimator::drawTrail() {
+        trails.update(orbitData, currentIndex);
+        trails.draw(worldProjection(), viewSize(), settings.lineWidth(), settings.trailColor());
+    }
+
+    /*! @brief Draws the coordinate axes, coordLength long (x in red, y in blue, z in green, as drawCoords() does).
+    */
+    void OrbitalAnimator::drawAxes() {
+        std::vector<GLfloat> axes;
+        LineRenderer::appendSegment(axes, -origin, Point3d(coordLength, 0, 0) - origin, QColor(255, 0, 0));
+        LineRenderer::appendSegment(axes, -origin, Point3d(0, coordLength, 0) - origin, QColor(0, 0, 255));
+        LineRenderer::appendSegment(axes, -origin, Point3d(0, 0, coordLength) - origin, QColor(0, 255, 0));
+        lines.draw(axes, viewProjection(), viewSize());
     }
 
     /*! @brief Draws the particles
 
-        This function draws all of the particles as spheres.
-        It simply iterates through orbitData, calculates the positions, and draws the particles.
-        This function does not get called if the full orbit is being drawn.
+        This function draws all of the particles of the prepared frame as discs, in one call to ParticleRenderer.
+        The positions were gathered ahead of time by FramePreparer; particles out of view are clipped by the GPU, and particles smaller
+        than a pixel are drawn one pixel wide.
+        Their color comes from the colormap (see updateColormap()), or is the orbit color if coloring by SingleColor.
         Only works if Orbit::calculatePosition() has been called on the particle.
     */
-    void OrbitalAnimator::drawParticle() {
+    void OrbitalAnimator::drawParticle(PreparedFrame const& frame) {
+        double diameter = 2. * frame.maxParticleSize * coordLength * frustum.pixelsPerUnit();
+        particles.drawUploaded(viewProjection(), diameter, settings.orbitColor(), colormap);
+    }
+
+    /*! @brief Labels the particles with their IDs
+
+        Labels are queued in the TextRenderer, which drops those that would overlap a label already placed, and are drawn
+        together with the rest of the overlay text at the end of paintGL().  Particles outside the view are skipped.
+    */
+    void OrbitalAnimator::drawLabels() {
+        QFont labelFont;
+        labelFont.setPointSize(10);
+        QColor color = settings.labelColor();
+        QPointF anchor;
         for (OrbitData::const_iterator itr = orbitData.begin(); itr != orbitData.end(); itr++) {
             if ((size_t)currentIndex < (itr->second).size()) {
-                glPushMatrix();
-                glColor4f((itr->second)[currentIndex].color.r,
-                          (itr->second)[currentIndex].color.g,
-                          (itr->second)[currentIndex].color.b,
-                          (itr->second)[currentIndex].color.alpha);
-                if((itr->second)[currentIndex].hasOrbEls == true){
-                    glRotatef((itr->second)[currentIndex].Omega, 0, 0, 1);
-                    glRotatef((itr->second)[currentIndex].i, 1, 0, 0);
-                    glRotatef((itr->second)[currentIndex].w, 0, 0, 1);
+                if (frustum.project((itr->second)[currentIndex].position(), anchor)) {
+                    text.addLabel(QString::number(itr->first), anchor + activeView.rect.topLeft(), labelFont, color);
                 }
-                glTranslatef((itr->second)[currentIndex].posInPlane.x,
-                             (itr->second)[currentIndex].posInPlane.y,
-                             (itr->second)[currentIndex].posInPlane.z);
-                Sphere obj(20, 20, (itr->second)[currentIndex].particleSize * coordLength);
-                obj.draw();
-                glPopMatrix();
+            }
+        }
+    }
+
+    /*! @brief Estimates how many particles are in view at the current frame.
+
+        Only a fixed number of particles, evenly spread through orbitData, are tested against the frustum, so the cost does not grow
+        with the number of particles.  The fraction found in view is scaled up to the whole set.
+    */
+    int OrbitalAnimator::estimateVisibleParticles() const {
+        const size_t samples = 4096;
+        size_t stride = std::max<size_t>(1, orbitData.size() / samples);
+        size_t tested = 0, visible = 0, k = 0;
+        for (OrbitData::const_iterator itr = orbitData.begin(); itr != orbitData.end(); ++itr, ++k) {
+            if (k % stride != 0) continue;
+            ++tested;
+            if ((size_t)currentIndex < (itr->second).size()) {
+                Orbit const& particle = (itr->second)[currentIndex];
+                if (frustum.classify(particle.position(), particle.particleSize * coordLength) != Outside) ++visible;
+            }
+        }
+        return tested ? int(double(visible) / tested * orbitData.size()) : 0;
+    }
+
+    /*! @brief Decides whether the particles are drawn individually or as a density (see DensityRenderer).
+
+        The density display takes over once more than OrbitalAnimatorSettings::densityThreshold() particles are in view, and hands back
+        to individual particles once fewer than 80% of that many are, so that zooming around the threshold does not flicker
+        between the two.
+    */
+    bool OrbitalAnimator::useDensity() {
+        int threshold = settings.densityThreshold();
+        if ((int)orbitData.size() < threshold) { densityMode = false; return false; }
+        int visible = estimateVisibleParticles();
+        if (densityMode) densityMode = visible > 0.8 * threshold;
+        else densityMode = visible > threshold;
+        return densityMode;
+    }
+
+    /*! @brief Draws every particle as a splat of the tone-mapped density.
+
+        Called instead of drawParticle() when useDensity() says so.
+    */
+    void OrbitalAnimator::drawDensity() {
+        density.draw(particles.uploadedBuffer(), particles.uploadedParticles(), viewProjection(), viewSize(), settings.orbitColor(),
+                     colormap, settings.densityExposure());
+    }
+
+    /*! @brief Adds the frame on screen, and as many others as fit in a few milliseconds, to the long exposure of the given (free) view.
+
+        The exposure is started over whenever the view or the particles' colors change (see LongExposure::setView()); other settings,
+        and the frame shown, leave it alone.  Until every frame is exposed, another repaint is requested so that the exposure keeps
+        filling in between user input.  While recording, only the frames played are exposed, so that every recorded frame shows
+        the same exposure whatever the time it took to render (see record()).
+    */
+    void OrbitalAnimator::updateExposure(PreparedFrame const& frame, View const& view) {
+        activeView = view;
+        double range[2] = { colormap.minimum(), colormap.maximum() };
+        QByteArray colormapKey(reinterpret_cast<char const*>(range), sizeof(range));
+        exposure.setView(viewProjection(), view.rect.size(), colormap.attribute(), settings.focusParticle(), settings.orbitColor(),
+                         colormapKey);
+        exposure.expose(frame.frame, frame.particles, density, colormap);
+        if (recording) return;
+        exposure.advance(8, density, colormap);
+        if (!exposure.complete()) requestRedraw();
+    }
+
+    /*! @brief Passes the attribute and range chosen in the settings to the colormap used by the particles and orbits.
+
+        With an automatic range, the colormap spans the values found in the data when it was loaded (see updateSimulationCache()).
+    */
+    void OrbitalAnimator::updateColormap() {
+        ColorAttribute attribute = ColorAttribute(std::max(0, std::min(int(ColorAttributeCount) - 1, settings.colorAttribute())));
+        colormap.setAttribute(attribute);
+        if (settings.colorRangeAuto()) colormap.setRange(attributeMin[attribute], attributeMax[attribute]);
+        else colormap.setRange(settings.colorRangeMin(), settings.colorRangeMax());
+        lines.setColormap(&colormap, settings.orbitColor());
+    }
+
+    /*! @brief Finds which of the prepared orbits are in view.
+
+        Orbits that are off-screen are left out and orbits smaller than a pixel are collapsed to a point (see ViewFrustum::classifyOrbit()).
+        A ring that circles the whole view is left out too, but not its plane, which then covers the view, so planes are only
+        tested against their bounding sphere.  As long as every ring (plane) is in view, the uploaded ones are drawn as they are;
+        otherwise the indices of the ones in view are gathered in visibleRings (visiblePlanes), so that no vertex is copied for a
+        view that shows only part of them.
+    */
+    void OrbitalAnimator::cullOrbits(PreparedFrame const& frame) {
+        const size_t ringSegmentFloats = LineRenderer::floatsPerVertex * LineRenderer::verticesPerSegment;
+        orbitsCollapsed = false;
+        allRingsVisible = true;
+        allPlanesVisible = true;
+        visibleRings.clear();
+        visiblePlanes.clear();
+        for (size_t r = 0; r < frame.ringOrbits.size(); ++r) {
+            PreparedFrame::RingOrbit const& orbit = frame.ringOrbits[r];
+            Visibility vis = frustum.classifyOrbit(Point3d(0, 0, 0), orbit.normal, orbit.periapsis, orbit.apoapsis);
+            if (vis == SubPixel) orbitsCollapsed = true;
+            if (vis != Visible) {
+                if (allRingsVisible && orbit.first > 0)
+                    LineRenderer::appendIndices(visibleRings, 0, int(orbit.first / ringSegmentFloats));
+                allRingsVisible = false;
+            } else if (!allRingsVisible) {
+                LineRenderer::appendIndices(visibleRings, GLuint(orbit.first / LineRenderer::floatsPerVertex),
+                                            int(orbit.count / ringSegmentFloats));
+            }
+
+            if (vis == Outside) vis = frustum.classify(Point3d(0, 0, 0), orbit.apoapsis);
+            if (vis != Visible) {
+                if (allPlanesVisible)
+                    visiblePlanes.assign(frame.planeIndices.begin(), frame.planeIndices.begin() + orbit.planeFirst);
+                allPlanesVisible = false;
+            } else if (!allPlanesVisible) {
+                visiblePlanes.insert(visiblePlanes.end(), frame.planeIndices.begin() + orbit.planeFirst,
+                                     frame.planeIndices.begin() + orbit.planeFirst + orbit.planeCount);
             }
         }
     }
@@ -316,60 +662,45 @@ namespace Disp
     /*! @brief Draws the full orbit of the first particle
 
         This function draws the whole orbit of the first particle as a circle.
+        The rings of all particles were rotated into the reference frame by FramePreparer, and those in view (see cullOrbits())
+        are drawn together by Disp::OrbitalAnimator::lines.
         Only works if Orbit::calculateOrbit() has been called on the particle.
     */
     void OrbitalAnimator::drawOrbit() {
-        for (OrbitData::const_iterator itr = orbitData.begin(); itr != orbitData.end(); itr++) { // iterate over particles
-            glPushMatrix();
+        if (allRingsVisible) lines.drawUploaded(viewProjection(), viewSize());
+        else lines.drawUploaded(visibleRings, viewProjection(), viewSize());
 
-            if ((size_t)currentIndex < (itr->second).size()) {
-                if(fillOrbits){
-                    glColor4f(settings.orbitalPlaneColor().red() / 255.,
-                          settings.orbitalPlaneColor().green() / 255.,
-                          settings.orbitalPlaneColor().blue() / 255.,
-                          settings.orbitalPlaneColor().alpha() / 255.);
-
-                    glRotatef((itr->second)[currentIndex].Omega, 0, 0, 1);
-                    glRotatef((itr->second)[currentIndex].i, 1, 0, 0);
-                    glRotatef((itr->second)[currentIndex].w, 0, 0, 1);
-                    glBegin(GL_POLYGON);
-                    for (int f = 0; f < 360; ++f) {
-                        glVertex3f((itr->second)[currentIndex].orbitCoords[f].x,
-                               (itr->second)[currentIndex].orbitCoords[f].y,
-                               (itr->second)[currentIndex].orbitCoords[f].z);
-                    }
-                    glEnd();
-                }
+        if (orbitsCollapsed) {
+            particles.draw(centralBody(), viewProjection(), 1.f, settings.orbitColor());
+        }
+    }
 
-                glColor4f(settings.orbitColor().red() / 255.,
-                          settings.orbitColor().green() / 255.,
-                          settings.orbitColor().blue() / 255.,
-                          settings.orbitColor().alpha() / 255.);
-                glBegin(GL_LINE_STRIP);
-                for (int f = 0; f < 360; ++f) {
-                    glVertex3f((itr->second)[currentIndex].orbitCoords[f].x,
-                               (itr->second)[currentIndex].orbitCoords[f].y,
-                               (itr->second)[currentIndex].orbitCoords[f].z);
-                    //qDebug() << ctr << (itr->second)[currentIndex].orbitCoords[f].x << (itr->second)[currentIndex].orbitCoords[f].y << (itr->second)[currentIndex].orbitCoords[f].z;
-                }
+    /*! @brief Fills the orbital planes in view, translucent, in the orbital plane color.
 
-                glVertex3f((itr->second)[currentIndex].orbitCoords[0].x,
-                           (itr->second)[currentIndex].orbitCoords[0].y,
-                           (itr->second)[currentIndex].orbitCoords[0].z);
-                glEnd();
-                glPopMatrix();
-            }
-        }
+        The planes are blended with order-independent transparency (see OrbitalPlaneRenderer), so they are drawn after everything
+        opaque, in one call, and the result does not depend on the order of the particles.
+    */
+    void OrbitalAnimator::drawOrbitalPlanes() {
+        if (allPlanesVisible) planes.draw(viewProjection(), viewSize(), settings.orbitalPlaneColor());
+        else planes.draw(visiblePlanes, viewProjection(), viewSize(), settings.orbitalPlaneColor());
     }
 
 
-    void OrbitalAnimator::drawOrbitalNormal()
-    {
-        glColor4f(settings.orbitColor().red() / 255.,
-                  settings.orbitColor().green() / 255.,
-                  settings.orbitColor().blue() / 255.,
-                  settings.orbitColor().alpha() / 255.);
-        drawVector(normals[currentIndex] * normalsScalar);
+    /*! @brief Draws an arrow at every particle along its orbit normal and/or its velocity, as chosen in the settings.
+
+        The arrows were computed for the whole frame by FramePreparer and are drawn as instances of one arrow mesh by
+        Disp::OrbitalAnimator::arrows, one draw call per set.  Normals are a quarter of their orbit's size long, in the orbit color;
+        velocities are scaled together so that the fastest particle's arrow is a tenth of coordLength long, in the velocity color.
+    */
+    void OrbitalAnimator::drawGlyphs(PreparedFrame const& frame) {
+        int count = int(frame.glyphs.size() / GlyphRenderer::floatsPerGlyph);
+        if (settings.displayNormals()) {
+            arrows.drawUploaded(0, frame.velocityGlyphs, viewProjection(), 1.f, settings.orbitColor());
+        }
+        if (settings.displayVelocities() && frame.maxSpeed > 0) {
+            arrows.drawUploaded(frame.velocityGlyphs, count - frame.velocityGlyphs, viewProjection(),
+                                float(0.1 * coordLength / frame.maxSpeed), settings.velocityColor());
+        }
     }
 
 
@@ -385,6 +716,8 @@ namespace Disp
         if (nothingLoaded()) { maximum = Point3d::minPoint(); minimum = Point3d::maxPoint(); }
 
         for (size_t i = 0; i < eclipticOrbits.size(); i++) eclipticOrbits[i].calculateOrbit(cosfs, sinfs);
+        buildStaticLayer(eclipticLayer, eclipticOrbits, false);
+        frameCache.clear();
 
         if (nothingLoaded()) {
             for (size_t i = 0; i < eclipticOrbits.size(); ++i)
@@ -394,7 +727,7 @@ namespace Disp
             }
         }
         loading = false;
-        updateGL();
+        requestRedraw();
     }
 
     /*! @brief Calls Orbit::calculateOrbit() on all the particles in equatorialOrbits
@@ -409,6 +742,8 @@ namespace Disp
         if (nothingLoaded()) { maximum = Point3d::minPoint(); minimum = Point3d::maxPoint(); }
 
         for (size_t i = 0; i < equatorialOrbits.size(); i++) equatorialOrbits[i].calculateOrbit(cosfs, sinfs);
+        buildStaticLayer(equatorialLayer, equatorialOrbits, true);
+        frameCache.clear();
 
         if (nothingLoaded()) {
             for (size_t i = 0; i < equatorialOrbits.size(); ++i)
@@ -418,7 +753,7 @@ namespace Disp
             }
         }
         loading = false;
-        updateGL();
+        requestRedraw();
     }
 
     /*! @brief Calls either Orbit::calculateOrbit() or Orbit::calculatePosition() on all the particles in orbitData
@@ -432,13 +767,26 @@ namespace Disp
         This function is called from Disp::OrbitalAnimationDriver::setSimulationData().
     */
     void OrbitalAnimator::updateSimulationCache(OrbitData const& d) {
+        preparer.invalidate();
+        exposure.setData(0, 0);
         orbitData = d;
+        trails.reset();
+        frameCache.clear();
 
         if (nothingLoaded()) { maximum = Point3d::minPoint(); minimum = Point3d::maxPoint(); }
 
         simulationSize = 0;
+        for (int a = 0; a < ColorAttributeCount; ++a) {
+            attributeMin[a] = std::numeric_limits<double>::max();
+            attributeMax[a] = -std::numeric_limits<double>::max();
+        }
         for (OrbitData::iterator itr = orbitData.begin(); itr != orbitData.end(); itr++) {
             for (size_t i = 0; i < (itr->second).size(); i++) {
+                for (int a = 0; a < ColorAttributeCount; ++a) {
+                    double value = Colormap::attributeValue((itr->second)[i], itr->first, ColorAttribute(a));
+                    attributeMin[a] = std::min(attributeMin[a], value);
+                    attributeMax[a] = std::max(attributeMax[a], value);
+                }
                 if ((itr->second)[i].hasOrbEls){
                     if (!drawFullOrbit) (itr->second)[i].calculatePosition(cosfs, sinfs);
                     else (itr->second)[i].calculateOrbit(cosfs, sinfs);
@@ -451,12 +799,17 @@ namespace Disp
             }
             if ((itr->second).size() > (size_t)simulationSize) simulationSize = (itr->second).size();
         }
+        for (int a = 0; a < ColorAttributeCount; ++a) {
+            if (attributeMin[a] > attributeMax[a]) { attributeMin[a] = 0; attributeMax[a] = 1; }
+        }
+        preparer.setData(&orbitData, simulationSize);
+        exposure.setData(&orbitData, simulationSize);
 
         coordLength = std::max(ABS(maximum.x), std::max(ABS(maximum.y), std::max(ABS(maximum.z),
                                std::max(ABS(minimum.x), std::max(ABS(minimum.y), ABS(minimum.z))))));
         settingsDialog->setFrameRange(simulationSize-1);
         loading = false;
-        updateGL();
+        requestRedraw();
 
     }
 
@@ -468,13 +821,15 @@ namespace Disp
     */
     void OrbitalAnimator::clearEquatorialData() {
         equatorialOrbits.clear();
+        equatorialLayer.clear();
+        frameCache.clear();
         equatorialDataLoaded = false;
         if (!eclipticDataLoaded && !simulationDataLoaded) {
             minimum = Point3d(0, 0, 0);
             maximum = Point3d(0, 0, 0);
             coordLength = 0;
         }
-        updateGL();
+        requestRedraw();
     }
 
     /*! @brief Removes the ecliptic orbits
@@ -485,13 +840,15 @@ namespace Disp
     */
     void OrbitalAnimator::clearEclipticData() {
         eclipticOrbits.clear();
+        eclipticLayer.clear();
+        frameCache.clear();
         eclipticDataLoaded = false;
         if (!equatorialDataLoaded && !simulationDataLoaded) {
             minimum = Point3d(0, 0, 0);
             maximum = Point3d(0, 0, 0);
             coordLength = 0;
         }
-        updateGL();
+        requestRedraw();
     }
 
     /*! @brief Removes the simulation data
@@ -501,14 +858,18 @@ namespace Disp
         Called when the "Remove Simulation Orbit" option is selected from the menubar.
     */
     void OrbitalAnimator::clearSimulationData() {
+        preparer.setData(0, 0);
+        exposure.setData(0, 0);
         orbitData.clear();
+        trails.reset();
+        frameCache.clear();
         simulationDataLoaded = false;
         if (!eclipticDataLoaded && !equatorialDataLoaded) {
             minimum = Point3d(0, 0, 0);
             maximum = Point3d(0, 0, 0);
             coordLength = 0;
         }
-        updateGL();
+        requestRedraw();
     }
 
     /*! @brief Removes everythign
@@ -517,16 +878,22 @@ namespace Disp
         Called when the "Remove All Orbits" option is selected from the menubar.
     */
     void OrbitalAnimator::clearAllData() {
+        preparer.setData(0, 0);
+        exposure.setData(0, 0);
         orbitData.clear();
+        trails.reset();
         eclipticOrbits.clear();
         equatorialOrbits.clear();
+        eclipticLayer.clear();
+        equatorialLayer.clear();
+        frameCache.clear();
         simulationDataLoaded = false;
         equatorialDataLoaded = false;
         eclipticDataLoaded = false;
         minimum = Point3d(0, 0, 0);
         maximum = Point3d(0, 0, 0);
         coordLength = 0;
-        updateGL();
+        requestRedraw();
     }
 
     /* @brief Keeps rotation angles in the range [-180,180].
@@ -538,126 +905,93 @@ namespace Disp
         else rot = xtemp;
     }*/
 
-    /*! @brief Keeps rotation angles in the range [-180,180].
+    /*! @brief Returns the state the queue's actions start from: the current rotations, zoom and frame.
     */
-    double checkRotRange(double rot) {
-        if (rot > 180.) rot -= 360.;
-        if (rot < -180.) rot += 360.;
-        return rot;
+    CameraState OrbitalAnimator::cameraState() const {
+        CameraState state = { xrotation, yrotation, zrotation, scaleFactor, currentIndex };
+        return state;
     }
 
-    /*! @brief Checks which direction to rotate is shorter, and returns dtheta.
-     *
-     * Wraps around 180, so rotation angle ranges are [-180,180].
+    /*! @brief Sets the rotations, zoom and frame to state, and moves the zoom and time sliders to match.  Does not redraw.
     */
-    double dThetaRotMin(double theta, double thetaFinal){
-        double theta1 = thetaFinal - theta;
-        double theta2 = (theta1 > 0) ? theta1 - 360. : theta1 + 360.; // rotation in other direction to theta1
-
-        return (abs(theta1) <= abs(theta2)) ? theta1 : theta2;
+    void OrbitalAnimator::showState(CameraState const& state) {
+        xrotation = state.xrot;
+        yrotation = state.yrot;
+        zrotation = state.zrot;
+        scaleFactor = state.scale;
+        currentIndex = state.frame;
+        settingsDialog->zoomScaleSlider->setDoubleValue(log10(scaleFactor));
+        settingsDialog->scrollTimeIndex->setValue(currentIndex);
+        settingsDialog->timeIndex->setValue(currentIndex);
     }
 
-    /*! @brief Rotates the simulation
+    /*! @brief SLOT showing frame of the timeline being played back.
 
-        This function rotates the simulation by (x, y, z) over "time."
+        Connected to player's frameReached().  Only asks for a redraw, so that a frame the display cannot keep up with is
+        replaced by the next one rather than delaying it.
     */
-    void OrbitalAnimator::rotate(double xrot, double yrot, double zrot, int time) {
-        int nFrames = int(time*FPS);
-        double dxrot = dThetaRotMin(xrotation, xrot) / (nFrames - 1.);
-        double dyrot = dThetaRotMin(yrotation, yrot) / (nFrames - 1.);
-        double dzrot = dThetaRotMin(zrotation, zrot) / (nFrames - 1.);
-
-        double xrotation_i = xrotation;
-        double yrotation_i = yrotation;
-        double zrotation_i = zrotation;
-
-        for (int i=0; i < nFrames; i++) {
-            xrotation = checkRotRange(xrotation_i + i*dxrot);
-            yrotation = checkRotRange(yrotation_i + i*dyrot);
-            zrotation = checkRotRange(zrotation_i + i*dzrot);
-            //settingsDialog->xRotationBox->setValue(xrotation);
-            //settingsDialog->yRotationBox->setValue(yrotation);
-            //settingsDialog->zRotationBox->setValue(zrotation);
-            updateOrRecord();
-        }
+    void OrbitalAnimator::showTimelineFrame(int frame) {
+        showState(player.timeline().at(frame));
+        requestRedraw();
     }
 
-    /*! @brief Zooms the simulation
+    /*! @brief Goes through every frame of timeline in turn, calling updateOrRecord() on each, without returning to the event loop.
 
-        This function zooms the simulation to "amt" over "time."
+        Used by record() and playThrough(), which must see every frame whatever the time it takes.
     */
-    void OrbitalAnimator::zoom(double amt, double time) {
-        int nFrames = int(time*FPS);
-        double dz = (amt - scaleFactor) / (nFrames - 1.);
-        double prevScaleFactor = scaleFactor;
-        for (int i=0; i < nFrames-1; i++) {
-            scaleFactor = prevScaleFactor + i*dz;
-            settingsDialog->zoomScaleSlider->setDoubleValue(log10(scaleFactor));
+    void OrbitalAnimator::renderTimeline(Timeline const& timeline) {
+        player.stop();
+        for (int f = 0; f < timeline.frames(); f++) {
+            showState(timeline.at(f));
             updateOrRecord();
         }
-
-        // do last step manually to ensure we reach specified scaleFactor at the end
-        settingsDialog->zoomScaleSlider->setDoubleValue(log10(amt));
-        scaleFactor = amt;
-        updateOrRecord();
     }
 
-    /*! @brief Plays the simulation
+    /*! @brief Splits the frames record() saves for queue into one segment per action, for RecordingManifest.
 
-        This function increases the frame number of the simulation by "amt" over "time."
+        Each segment's hash covers its action and the hash of the segment before it; the first one's also covers the data
+        (its number of particles and frames, and the first and last orbits), the settings, the size of the frames, the camera the
+        queue starts from (cameraState()) and what is drawn besides the settings (full orbits, filled planes, particles, and
+        the equatorial and ecliptic orbits).
+        Editing an action thus changes the hashes of its segment and of all those after it, whose frames are rendered again.
     */
-    void OrbitalAnimator::simulate(int frameFinal, int time) {
-        int nFrames = int(time*FPS); // number of frames we need to create
-        double deltaFrame = double(frameFinal-currentIndex)/double(nFrames-1.);
-        int indexInitial = currentIndex;
-        for (int i=0; i < nFrames; i++) {
-            currentIndex = int(round(indexInitial + i*deltaFrame));
-            settingsDialog->scrollTimeIndex->setValue(currentIndex);
-            settingsDialog->timeIndex->setValue(currentIndex);
-            updateOrRecord();
+    std::vector<RecordingManifest::Segment> OrbitalAnimator::recordingSegments(QTableWidget* queue, QSize const& size) const {
+        QByteArray base;
+        QDataStream data(&base, QIODevice::WriteOnly);
+        CameraState start = cameraState();
+        data << quint32(orbitData.size()) << simulationSize << size << settings.hash()
+             << start.xrot << start.yrot << start.zrot << start.scale << start.frame
+             << drawFullOrbit << fillOrbits << drawParticles << equatorialDataLoaded << eclipticDataLoaded;
+        if (!orbitData.empty()) {
+            std::vector<Orbit> const& firstOrbits = orbitData.begin()->second;
+            std::vector<Orbit> const& lastOrbits = orbitData.rbegin()->second;
+            if (!firstOrbits.empty()) data << firstOrbits.front().time << firstOrbits.front().axis << firstOrbits.back().time;
+            if (!lastOrbits.empty()) data << lastOrbits.front().axis << lastOrbits.back().time << lastOrbits.back().axis;
         }
-    }
+        QByteArray hash = QCryptographicHash::hash(base, QCryptographicHash::Sha1).toHex();
 
-    /*! @brief Pauses the simulation
-
-        This function pauses for "time" frames.
-    */
-    void OrbitalAnimator::doNothing(int time) { for (int i=0; i < time; i++) updateOrRecord(); }
-
-    /*! @brief Sets the simulation state
-
-        This function sets the simulation to the passed state.
-        Rotations are set to (x,y,z), zoom is set to "sc", and frame number is set to "fr."
-    */
-    void OrbitalAnimator::initialize(double x, double y, double z, double sc, int fr) {
-        xrotation = x;
-        yrotation = y;
-        zrotation = z;
-        scaleFactor = sc;
-        currentIndex = fr;
-        qDebug() << currentIndex;
-        //settingsDialog->xRotationBox->setValue(xrotation);
-        //settingsDialog->yRotationBox->setValue(yrotation);
-        //settingsDialog->zRotationBox->setValue(zrotation);
-        settingsDialog->zoomScaleSlider->setDoubleValue(log10(scaleFactor));
-        settingsDialog->scrollTimeIndex->setValue(currentIndex);
-        settingsDialog->timeIndex->setValue(currentIndex);
-        updateOrRecord();
+        std::vector<RecordingManifest::Segment> segments;
+        int first = 0;
+        for (int i=0; i < queue->rowCount(); i++) {
+            Action act = queue->item(i, 0)->data(Qt::UserRole).value<Action>();
+            QByteArray bytes = hash;
+            QDataStream out(&bytes, QIODevice::WriteOnly | QIODevice::Append);
+            out << act.typ << act.span << act.xrot << act.yrot << act.zrot << act.scale << act.frame;
+            hash = QCryptographicHash::hash(bytes, QCryptographicHash::Sha1).toHex();
+            RecordingManifest::Segment segment = { first, Timeline::framesOf(act), hash };
+            segments.push_back(segment);
+            first += segment.count;
+        }
+        return segments;
     }
 
-    /*! @brief Executes an action
-
-        This function takes in an Action (defined in Queue.h) and executes it in the simulation
-        (from the current state).
+    /*! @brief Returns the number of frames record() saves for the whole queue, so that it can be split into ranges.
     */
-    void OrbitalAnimator::performAction(Action act) {
-        switch (act.typ) {
-        case ROTATE: rotate(act.xrot, act.yrot, act.zrot, act.span); break;
-        case ZOOM: zoom(act.scale, act.span); break;
-        case SIMULATE: simulate(act.frame, act.span); break;
-        case PAUSE: doNothing(act.span); break;
-        case INITIALIZE: initialize(act.xrot, act.yrot, act.zrot, act.scale, act.frame);
-        }
+    int OrbitalAnimator::recordedFrames(QTableWidget* queue) {
+        int frames = 0;
+        for (int i=0; i < queue->rowCount(); i++)
+            frames += Timeline::framesOf(queue->item(i, 0)->data(Qt::UserRole).value<Action>());
+        return frames;
     }
 
 /* Need a way to access previous queue action to set state or store previous values
@@ -693,14 +1027,14 @@ namespace Disp
     }
 */
 
-    /*! @brief Iterates through queue and calls Disp::OrbitalAnimator::performAction() on each item.
+    /*! @brief Plays the queue back in real time, from the current state, and returns right away.
+
+        The actions are laid out as a Timeline, which player evaluates at the frame the clock has reached (see TimelinePlayer):
+        the event loop keeps running, the playback can be paused, moved or stopped, and it lasts as long as the recording will
+        whatever the time a frame takes to render.
     */
     void OrbitalAnimator::playbackQueue(QTableWidget* queue) {
-        for (int i=0; i < queue->rowCount(); i++) {
-            QVariant v = queue->item(i, 0)->data(Qt::UserRole);
-            Action act = v.value<Action>();
-            performAction(act);
-        }
+        player.play(Timeline(Timeline::actionsOf(queue), cameraState()));
     }
 
     /*! @brief Does the same thing as playbackQueue, except it records as it does so.
@@ -712,50 +1046,80 @@ namespace Disp
         // first make a dialog to get the folder wants to store images in
         QString dirName = QFileDialog::getExistingDirectory(this, tr("Choose or create the folder to which you want images output"), qgetenv("HOME"), QFileDialog::ShowDirsOnly);
         if(dirName.compare(QString(""), Qt::CaseSensitive) == 0) {   return;  } // if the directory name = "", then user hit cancel so we return
-        tmpPNGFolder = QDir(dirName);
-
-        recording = true;
-        playbackQueue(queue);   // generate images
-
-        recording = false;
-        pictureNumber = 0;
+        record(queue, dirName);
     }
-/*    /*! @brief stitches the movie out of individual frames using the ffmpeg library
 
-    void OrbitalAnimator::makeMovie(QString moviePath)
-    {
-        int argc = 8;
+    /*! @brief Does the same thing as record(), but makes a single movie file instead of a folder of pictures.
 
-        QString input = tmpPNGFolder.absolutePath() + "/orb%05d.png";
+        Launches a QFileDialog to ask for the movie's name; its suffix chooses the format (see VideoSink).
+    */
+    void OrbitalAnimator::recordMovie(QTableWidget* queue) {
+        QString fileName = QFileDialog::getSaveFileName(this, tr("Choose the movie to record"), qgetenv("HOME"),
+                                                        tr("Movies, encoded by ffmpeg (*.mp4 *.mkv *.mov);;YUV4MPEG2 (*.y4m);;Raw RGB frames (*.rgb)"));
+        if (fileName.isEmpty()) return;     // user hit cancel
+        if (!VideoSink::handles(fileName)) fileName += ".mp4";
+        if (!record(queue, fileName))
+            QMessageBox::warning(this, tr("Record Movie"), tr("The movie could not be written.  Is ffmpeg installed?"));
+    }
 
-        char arg0[] = "ffmpeg";
-        char arg1[] = "-i";
-        char arg2[input.size()+1];
-        memcpy(arg2, input.toStdString().c_str(), input.size()+1);
-        char arg3[] = "-c:v";
-        char arg4[] = "libx264";
-        char arg5[] = "-pix_fmt";
-        char arg6[] = "yuv420p";
-        char arg7[moviePath.size()+1];
-        memcpy(arg7, moviePath.toStdString().c_str(), moviePath.size()+1);
+    /*! @brief Plays back the queue, saving every frame to output: a movie if it has the suffix of one (see VideoSink::handles()),
+        and pictures in the folder output otherwise.
 
-        char *argv[] = { &arg0[0], &arg1[0], &arg2[0], &arg3[0], &arg4[0], &arg5[0], &arg6[0], &arg7[0]};
-        int errorCode;
+        Only frames first to last - 1 (all from first on if last is negative) are rendered and saved; the others are only played
+        through, which is cheap, to reach the state the range starts from.  The queue being deterministic, a long recording can
+        thus be rendered by several processes, each given a range (see the batch mode's --jobs).  Stills keep their numbers in the
+        whole recording; a movie holds the range alone.  A long exposure is the exception: it is started over and exposes the
+        frames as they are played, so it can only be recorded from the first frame, and returns false otherwise.
 
-        errorCode = ffmpeg(argc, argv);
+        Recording stills into a folder that already holds a recording only renders the frames that are missing or have changed:
+        an interrupted recording resumes where it stopped, and a queue whose last actions were edited has only their frames
+        rendered again (see RecordingManifest and recordingSegments()).  A movie is always recorded whole.
 
-        if(errorCode)
-        {
-            qDebug("ffmpeg returned non-zero value: %i", errorCode);
-            exit(errorCode);
+        The frames are rendered into recordTarget, at OrbitalAnimatorSettings::recordSize() (the widget's size if it is empty), and
+        read back and saved by recorder while the next ones are rendered (see FrameRecorder); this returns once the last of them is
+        written.  The x264 codec requires even dimensions, so an odd last column or row is left out.
+        Returns false if the output could not be written.
+    */
+    bool OrbitalAnimator::record(QTableWidget* queue, QString const& output, int first, int last) {
+        QSize size = settings.recordSize().isEmpty() ? this->size() : settings.recordSize();
+        size = QSize(size.width() - size.width()%2, size.height() - size.height()%2);
+        bool movie = VideoSink::handles(output);
+        if (settings.longExposure() && first > 0) return false;
+        // a long exposure adds up every frame rendered, so none can be skipped: it gets no segments, and keeps no frames
+        std::vector<RecordingManifest::Segment> segments;
+        if (!settings.longExposure()) segments = recordingSegments(queue, size);
+        if (!movie) manifest.open(output, segments, first, last);
+        QScopedPointer<FrameSink> sink(movie ? static_cast<FrameSink*>(new VideoSink(output, first))
+                                             : new ImageSequenceSink(output, &manifest));
+        makeRenderContextCurrent();
+        if (!createRecordTarget(size) || !recorder.begin(size, font(), sink.data(), FPS)) {
+            releaseRecordTarget();
+            manifest.close();
+            return false;
         }
+        recordFirst = first;
+        recordLast = last;
+        recording = true;
+        exposure.reset();
+        renderTimeline(Timeline(Timeline::actionsOf(queue), cameraState()));    // generate images
+
+        makeRenderContextCurrent();
+        bool written = recorder.finish();
+        releaseRecordTarget();
+        manifest.close();
+        recording = false;
+        pictureNumber = 0;
+        return written;
     }
-*/
     /*! @brief Depending on whether the bool recording is true, either calls updateGL() or saveCurrentImage().
+
+        While recording, frames outside the range given to record(), and frames the manifest says are already on disk, are
+        counted but not rendered.
     */
     void OrbitalAnimator::updateOrRecord() {
         if (recording) {
-            saveCurrentImage(pictureNumber);
+            if (pictureNumber >= recordFirst && (recordLast < 0 || pictureNumber < recordLast) && !manifest.done(pictureNumber))
+                saveCurrentImage(pictureNumber);
             pictureNumber++;
         }
         else updateGL();
@@ -774,7 +1138,7 @@ namespace Disp
         else scaleFactor *= pow(1.25, numSteps);
 
         settingsDialog->zoomScaleSlider->setDoubleValue(log10(scaleFactor));
-        updateGL();
+        requestRedraw();
     }
 
     /*! @brief Rotates the simulation based on mouse dragging movement.
@@ -794,14 +1158,14 @@ namespace Disp
             zrotation = checkRotRange(zrotation + speed * dx);
             //settingsDialog->yRotationBox->setValue(yrotation);
             //settingsDialog->zRotationBox->setValue(zrotation);
-            updateGL();
+            requestRedraw();
         }
         else if (event->buttons() & Qt::RightButton) {
             yrotation = checkRotRange(yrotation + speed * dy);
             xrotation = checkRotRange(xrotation + speed * dx);
             //settingsDialog->yRotationBox->setValue(yrotation);
             //settingsDialog->xRotationBox->setValue(xrotation);
-            updateGL();
+            requestRedraw();
         }
 
         lastPos = event->pos();
@@ -828,7 +1192,7 @@ namespace Disp
     template<>
     void OrbitalAnimator::setTextColor<OrbitalAnimator::OpenGL>(QColor c)
     {
-        glColor4f(c.red() / 255., c.green() / 255., c.blue() / 255., c.alpha() / 255.);
+        textColor = c;
     }
 
     template<>
@@ -841,7 +1205,7 @@ namespace Disp
     template<>
     void OrbitalAnimator::drawText<OrbitalAnimator::OpenGL>(QString str, int topLeftX, int topLeftY, QFontMetrics* fm)
     {
-        renderText(topLeftX, fm->height() + topLeftY, str);
+        text.addText(str, QPointF(topLeftX, fm->height() + topLeftY), font(), textColor);
     }
 
     /*! @brief Writes "Loading" while a simulation is being loaded.
@@ -852,10 +1216,17 @@ namespace Disp
     {
         setTextColor<disp>(QColor(0, 255, 0, 255));
         QFontMetrics fm(font());
-        QString text;
-        text = QString("Loading...");
-        int textWidth = fm.width(text);
-        drawText<disp>(text, width() - textWidth - 10, height() - 50, &fm);
+        QString message("Loading...");
+        int textWidth = fm.width(message);
+        drawText<disp>(message, renderSize().width() - textWidth - 10, renderSize().height() - 50, &fm);
+    }
+
+    /*! @brief The time of the current frame, as it is written on the display and on recorded frames.
+    */
+    QString OrbitalAnimator::timeLabel() const
+    {
+        OrbitData::const_iterator itr = orbitData.begin();
+        return QString("%1 yrs").arg(int((itr->second)[currentIndex].time));
     }
 
     /*! @brief Writes the time to the frame.
@@ -864,14 +1235,11 @@ namespace Disp
     template<OrbitalAnimator::Display disp>
     void OrbitalAnimator::drawTime()
     {
-        OrbitData::const_iterator itr = orbitData.begin();
-        double time = (itr->second)[currentIndex].time;
         setTextColor<disp>(QColor(255, 255, 255, 255));
         QFontMetrics fm(font());
-        QString text;
-        text = QString("%1 yrs").arg(int(time));
-        int textWidth = fm.width(text);
-        drawText<disp>(text, (width() - textWidth)/2. , 5, &fm);
+        QString label = timeLabel();
+        int textWidth = fm.width(label);
+        drawText<disp>(label, (renderSize().width() - textWidth)/2. , 5, &fm);
     }
 
     /*! @brief Writes the rotation, zoom and frame values on the display.
@@ -889,19 +1257,19 @@ namespace Disp
         QString frame = QString("Frame Number : %1").arg(simulationDataLoaded ? currentIndex : 0);
         QFont f;
         f.setPointSize(16);
-        renderText(10, 25, x, f); // renderText writes the 3rd parameter passed, at the pixel locations passed in the first two parameters.
-        renderText(10, 45, y, f);
-        renderText(10, 65, z, f);
-        renderText(10, 85, zoom, f);
-        renderText(10, 105, frame, f);
+        text.addText(x, QPointF(10, 25), f, textColor); // writes the 1st parameter passed with its baseline starting at the pixel location passed.
+        text.addText(y, QPointF(10, 45), f, textColor);
+        text.addText(z, QPointF(10, 65), f, textColor);
+        text.addText(zoom, QPointF(10, 85), f, textColor);
+        text.addText(frame, QPointF(10, 105), f, textColor);
     }
 
     /*! @brief SLOT executed when xrotation value is changed by the user in the SettingsDialog, which governs the display's orientation (around the x axis).*/
-    void OrbitalAnimator::setXRot(double deg) { xrotation = std::max(-180.0, std::min(180.0, deg)); updateGL(); }
+    void OrbitalAnimator::setXRot(double deg) { xrotation = std::max(-180.0, std::min(180.0, deg)); requestRedraw(); }
     /*! @brief SLOT executed when yrotation value is changed by the user in the SettingsDialog, which governs the display's orientation (around the y axis).*/
-    void OrbitalAnimator::setYRot(double deg) { yrotation = std::max(-180.0, std::min(180.0, deg)); updateGL(); }
+    void OrbitalAnimator::setYRot(double deg) { yrotation = std::max(-180.0, std::min(180.0, deg)); requestRedraw(); }
     /*! @brief SLOT executed when zrotation value is changed by the user in the SettingsDialog, which governs the display's orientation (around the z axis).*/
-    void OrbitalAnimator::setZRot(double deg) { zrotation = std::max(-180.0, std::min(180.0, deg)); updateGL(); }
+    void OrbitalAnimator::setZRot(double deg) { zrotation = std::max(-180.0, std::min(180.0, deg)); requestRedraw(); }
 
     /*! @brief SLOT executed when zoom is changed in the SettingsDialog.
 
@@ -910,7 +1278,7 @@ namespace Disp
     {
         zoom = std::max(0.001, std::min(100000.0, zoom));
         scaleFactor = zoom;
-        updateGL();
+        requestRedraw();
     }
 
     /*! @brief SLOT executed when the index is changed.
@@ -919,7 +1287,17 @@ namespace Disp
     void OrbitalAnimator::setCurrentIndex(int index)
     {
         currentIndex = std::max(std::min(index, simulationSize - 1), 0);
-        updateGL();
+        requestRedraw();
+    }
+
+    /*! @brief SLOT executed when the user moves the time slider, just before the index changes.
+
+        Only the frames reached this way are kept in frameCache: the frames shown by a playback or by the SettingsDialog's
+        animation also go through setCurrentIndex(), and reading each of them back would slow them down and push the frames
+        kept for scrubbing out of the cache.  Connected in OrbitalAnimationDriver::makeConnections().*/
+    void OrbitalAnimator::timeScrubbed()
+    {
+        timeMoved = true;
     }
 
     /*! @brief Moves the simulation frame forward one, and resets the frame to the beginning if it reaches the end. */
@@ -927,7 +1305,7 @@ namespace Disp
     {
         ++currentIndex;
         if (currentIndex > simulationSize) currentIndex = 0;
-        updateGL();
+        requestRedraw();
     }
 
     /*void OrbitalAnimator::printImages(QString directory, int timeStep) DEPRECATED
@@ -964,71 +1342,193 @@ namespace Disp
         currentIndex = prevIndex;
     }*/
 
-    /*! @brief saves a snapshot of the OrbitalAnimator to a file with the passed id at the end, in the directory passed.
+    /*! @brief Renders the current state into recordTarget and hands it to recorder as frame id of the recording.
 
-        Has to set the filename written out to have the same number of digits for every frame, e.g., 1 -> 00001, so that ffmpeg can read it.
-        I set the number of digits to 5.  The limit of 10^5 frames corresponds at ~30 fps to an hour-long video, which presumably is enough!
         Called by OrbitalAnimator::updateOrRecord()
     */
-
     void OrbitalAnimator::saveCurrentImage(int id)
     {
-        QString fileNameTemplate("orb%1.png");
-        if (tmpPNGFolder.exists())
-            fileNameTemplate = tmpPNGFolder.absolutePath() + QString("/") + fileNameTemplate;
-        else {
-            qWarning("Bug:  Folder to put still images in was not created properly");
-            exit(1);
+        QOpenGLFramebufferObject* source = renderToTarget();
+
+        // only queues the readback: the pixels are picked up a few frames later, and flipped, captioned with the time and
+        // passed to the stills or the movie on recorder's worker threads (see FrameRecorder)
+        recorder.capture(id, timeLabel());
+        source->release();
+    }
+
+    /*! @brief Renders the current state into recordTarget, and returns the framebuffer to read it from, bound.
+    */
+    QOpenGLFramebufferObject* OrbitalAnimator::renderToTarget()
+    {
+        makeRenderContextCurrent();
+        recordTarget->bind();
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f );
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        paintGL();
+
+        // a multisampled target cannot be read directly: its samples are averaged into recordResolve first
+        QOpenGLFramebufferObject* source = recordTarget.data();
+        if (recordResolve) {
+            QOpenGLFramebufferObject::blitFramebuffer(recordResolve.data(), recordTarget.data());
+            source = recordResolve.data();
         }
+        source->bind();
+        return source;
+    }
 
-        // need to make the filename the same number of digits in every frame so that ffmpeg can read them
-        QString fname = fileNameTemplate.arg(pictureNumber, 5, 'f', 0, '0'); // these arguments mean that there should be 5 digits, the format should be 'f'
-                                                                            // (no scientific notation), that there should be 0 digits after the decimal
-                                                                            // and that the filler characters should be zeroes (to put in front of the ID if
-                                                                            // it's less than 5 digits)
-        {
-            QGLFramebufferObject buffer(width(), height(), QGLFramebufferObject::CombinedDepthStencil);
-            buffer.bind();
-            glClearColor(0.0f, 0.0f, 0.0f, 1.0f );
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            paintGL();
+    /*! @brief Saves the current state as an image of any size (e.g., a 16384x16384 poster) in path, a PNG or PPM file.
+
+        The image is cut into a grid of tiles no larger than 2048 pixels (nor than the context's renderbuffers can be), which are
+        rendered one after the other into recordTarget with tileTransform narrowing the projection to them; each row of tiles is
+        then written out by a StreamingImageWriter, so that only one row is ever in memory.  OpenGL drops a point sprite whose
+        center is outside the viewport, which would cut the particles on the edges of the tiles, so each tile is rendered with a
+        guard band half as wide as the largest particle around it, which is cropped off; the particles' size is found by a first
+        render of a small tile at the poster's scale (see ParticleRenderer::largestDiameter()).  Sizes given in pixels, such as the
+        line width and the text, stay the same, so they look thinner and smaller the larger the image.  The overlays that belong
+        to the display (the time and the view names) are left out, and the free view is drawn alone.
+        Returns false if the image could not be written.
+    */
+    bool OrbitalAnimator::renderPoster(QString const& path, QSize const& size)
+    {
+        makeRenderContextCurrent();
+        GLint maxSize = 0;
+        glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxSize);
+        int side = std::max(1, std::min(int(maxSize), 2048));
+
+        tiling = true;
+        QSize probe(64, 64);
+        if (!createRecordTarget(probe)) {
+            tiling = false;
+            return false;
+        }
+        setTileTransform(QRect(QPoint(0, 0), probe), size);
+        particles.resetLargestDiameter();
+        renderToTarget()->release();
+        int guard = std::max(0, std::min(int(std::ceil(particles.largestDiameter() / 2)) + 1, (side - probe.width()) / 2));
+        side = std::max(probe.width(), side - 2 * guard);
+        releaseRecordTarget();
+
+        int columns = (size.width() + side - 1) / side, rows = (size.height() + side - 1) / side;
+        QSize tile((size.width() + columns - 1) / columns, (size.height() + rows - 1) / rows);
+        bool written = createRecordTarget(tile + QSize(2 * guard, 2 * guard));
+        StreamingImageWriter writer;
+        written = written && writer.open(path, size);
+        for (int r = 0; r < rows && written; ++r) {
+            QImage strip(size.width(), tile.height(), QImage::Format_RGB32);
+            QPainter painter(&strip);
+            for (int c = 0; c < columns; ++c) {
+                QRect rect(c * tile.width(), r * tile.height(), tile.width(), tile.height());
+                setTileTransform(rect.adjusted(-guard, -guard, guard, guard), size);
+                QOpenGLFramebufferObject* source = renderToTarget();
+                painter.drawImage(rect.x(), 0, source->toImage(), guard, guard, rect.width(), rect.height());
+                source->release();
+            }
+            painter.end();
+            written = writer.write(strip);
+        }
+        tiling = false;
+        tileTransform.setToIdentity();
+
+        makeRenderContextCurrent();
+        releaseRecordTarget();
+        written = writer.close() && written;
+        requestRedraw();
+        return written;
+    }
 
-            buffer.release();
+    /*! @brief Sets tileTransform so that the whole viewport shows only rect, in pixels from the top left, of an image of the given
+        size (see renderPoster()).
+    */
+    void OrbitalAnimator::setTileTransform(QRect const& rect, QSize const& size)
+    {
+        // the tile's rectangle is [cx - w/W, cx + w/W] x [cy - h/H, cy + h/H] in normalized device coordinates (y up)
+        double cx = (2. * rect.x() + rect.width()) / size.width() - 1;
+        double cy = 1 - (2. * rect.y() + rect.height()) / size.height();
+        tileTransform.setToIdentity();
+        tileTransform.scale(double(size.width()) / rect.width(), double(size.height()) / rect.height(), 1);
+        tileTransform.translate(-cx, -cy, 0);
+    }
 
-            /* the x264 codec requires that the images passed to it have even dimensions (e.g., 546x468).  So we first make a temporary pixmap to store the image,
-               and then use its copy function to generate our final image with the values in ptemp, bounded by the rectangle defined by the 4 passed values.
-               The first two are the (x,y) coordinates to start from--(0,0) is the top left corner--and then you provide the width and height of the image.
-               We pass the value from ptemp - the width (or height) modulo 2.  If the number was even, modulo 2 = 0 and it's unchanged.  If odd, modulo 2 = 1,
-               and we pass it one less than the original value.  So if both dimensions were odd, it would cut off the right-most column and bottom row of the image.
-            */
+    /*! @brief Plays the queue through to its end without rendering anything, e.g., to save a poster of the state it ends in.
+    */
+    void OrbitalAnimator::playThrough(QTableWidget* queue)
+    {
+        recordFirst = recordLast = 0;   // an empty range: updateOrRecord() only counts the frames
+        recording = true;
+        renderTimeline(Timeline(Timeline::actionsOf(queue), cameraState()));
+        recording = false;
+        pictureNumber = 0;
+        recordLast = -1;
+    }
 
-            QPixmap ptemp(QPixmap::fromImage(buffer.toImage()));
-            QPixmap p = ptemp.copy(0,0,ptemp.width()-ptemp.width()%2, ptemp.height()-ptemp.height()%2);
+    /*! @brief Allocates the framebuffer the frames of a recording are rendered into, once for the whole recording.
 
-            QPainter painter(&p);
-            painter.setFont(font());
-            currentPainter = &painter;
-            drawTime<Pixmap>();
-            currentPainter = 0;
+        It has OrbitalAnimatorSettings::recordSamples() samples per pixel if the context can resolve them (which takes a framebuffer
+        blit), and none otherwise.  Returns false if size is larger than the context's renderbuffers can be, or the framebuffer
+        is not complete.  Must be called with the context current.
+    */
+    bool OrbitalAnimator::createRecordTarget(QSize const& size)
+    {
+        GLint maxSize = 0;
+        glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxSize);
+        if (size.width() > maxSize || size.height() > maxSize) {
+            qWarning() << "OrbitalAnimator: cannot record at" << size << "as renderbuffers are at most" << maxSize << "pixels wide";
+            return false;
+        }
 
-            p.save(fname);
+        QOpenGLFramebufferObjectFormat format;
+        format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+        if (settings.recordSamples() > 0 && QOpenGLFramebufferObject::hasOpenGLFramebufferBlit())
+            format.setSamples(settings.recordSamples());
+        recordTarget.reset(new QOpenGLFramebufferObject(size, format));
+        if (recordTarget->format().samples() > 0) recordResolve.reset(new QOpenGLFramebufferObject(size));
+        if (!recordTarget->isValid() || (recordResolve && !recordResolve->isValid())) {
+            qWarning() << "OrbitalAnimator: could not create a framebuffer of" << size << "to record into";
+            releaseRecordTarget();
+            return false;
         }
+        return true;
+    }
+
+    /*! @brief Frees the framebuffers of createRecordTarget().  Must be called with the context current.
+    */
+    void OrbitalAnimator::releaseRecordTarget()
+    {
+        recordResolve.reset();
+        recordTarget.reset();
+    }
+
+    /*! @brief Plays the single action act back from the current state, like playbackQueue().
+    */
+    void OrbitalAnimator::playAction(Action const& act) {
+        player.play(Timeline(std::vector<Action>(1, act), cameraState()));
     }
 
     /* Used by commented out code in settingsDialog for doing relative rotations (e.g., rotate by 30 degrees from current state)*/
     void OrbitalAnimator::rotate() {
-        rotate(settingsDialog->rotateAmountX->value(),
-               settingsDialog->rotateAmountY->value(),
-               settingsDialog->rotateAmountZ->value(),
-               settingsDialog->rotateSpeed->value());
+        Action act = Action();
+        act.typ = ROTATE;
+        act.xrot = settingsDialog->rotateAmountX->value();
+        act.yrot = settingsDialog->rotateAmountY->value();
+        act.zrot = settingsDialog->rotateAmountZ->value();
+        act.span = settingsDialog->rotateSpeed->value();
+        playAction(act);
     }
 
     void OrbitalAnimator::zoom() {
-        zoom(settingsDialog->zoomAmount->value(), settingsDialog->zoomSpeed->value());
+        Action act = Action();
+        act.typ = ZOOM;
+        act.scale = settingsDialog->zoomAmount->value();
+        act.span = settingsDialog->zoomSpeed->value();
+        playAction(act);
     }
 
     void OrbitalAnimator::simulate() {
-        simulate(settingsDialog->simulateAmount->value(), settingsDialog->simulateSpeed->value());
+        Action act = Action();
+        act.typ = SIMULATE;
+        act.frame = settingsDialog->simulateAmount->value();
+        act.span = settingsDialog->simulateSpeed->value();
+        playAction(act);
     }
 
 }
@@ -38,16 +38,45 @@
 
 #include "Helpers/Point3d.h"
 #include "Helpers/GLDrawingFunctions.h"
+#include "Helpers/ViewFrustum.h"
+#include "Helpers/ParticleTrails.h"
+#include "Helpers/TextRenderer.h"
+#include "Helpers/StaticOrbitLayer.h"
+#include "Helpers/LineRenderer.h"
+#include "Helpers/DensityRenderer.h"
+#include "Helpers/Colormap.h"
+#include "Helpers/ParticleRenderer.h"
+#include "Helpers/FramePreparer.h"
+#include "Helpers/GLProfile.h"
+#include "Helpers/OrbitalPlaneRenderer.h"
+#include "Helpers/GlyphRenderer.h"
+#include "Helpers/LongExposure.h"
+#include "Helpers/FrameScheduler.h"
+#include "Helpers/FrameRecorder.h"
+#include "Helpers/RecordingManifest.h"
+#include "Helpers/FrameCache.h"
+#include "Helpers/StreamingImageWriter.h"
 #include "Settings.h"
 #include "SettingsDialog.h"
 #include "QueueActionDialog.h"
+#include "Timeline.h"
 #include "OrbitalAnimationDriver.h"
 #include "Helpers/Orbit.h"
 #include <QtOpenGL/QGLWidget>
+#ifdef OGRE_CORE_PROFILE
+#include <QtWidgets/QOpenGLWidget>
+#endif
+#include <QtGui/QOpenGLVertexArrayObject>
+#include <QtGui/QOpenGLFramebufferObject>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOffscreenSurface>
+#include <QtCore/QScopedPointer>
 #include <QFileDialog>
 #include <QtGui/QPainter>
 #include <QtGui/QProgressDialog>
 #include <QtGui/QWheelEvent>
+#include <QtGui/QGuiApplication>
+#include <QtGui/QScreen>
 #include <QFontMetrics>
 #include <QtOpenGL/QGLFramebufferObject>
 #include <QtCore/QDebug>
@@ -83,15 +112,29 @@ extern "C" {
 */
 namespace Disp
 {
+    /*! @brief The widget the OrbitalAnimator draws in.
+
+        A core_profile build (see OrbitVisualizer.pro) draws in a QOpenGLWidget with an OpenGL 3.2 core-profile context;
+        otherwise the legacy QGLWidget is used.  The drawing code is the same for both, see GLProfile.
+    */
+#ifdef OGRE_CORE_PROFILE
+    typedef QOpenGLWidget AnimatorWidget;
+#else
+    typedef QGLWidget AnimatorWidget;
+#endif
+
     /*! @brief class that does the OpenGL drawing
     */
-    class OrbitalAnimator : public QGLWidget
+    class OrbitalAnimator : public AnimatorWidget
     {
         Q_OBJECT
     public:
         /*! @brief Constructor
         */
         OrbitalAnimator(OrbitalAnimatorSettings& settings_, QWidget *parent = 0);
+        /*! @brief Destructor.  Makes the context current so the GPU resources can be released.
+        */
+        ~OrbitalAnimator();
         /*! @brief Initializes the OrbitalAnimator instance
         */
         QWidget* setupUI(OrbitalAnimatorSettings& animatorSettings);
@@ -109,8 +152,7 @@ namespace Disp
         void setFullOrbit(bool b) { drawFullOrbit = b; }
         void setdrawParticles(bool b) { drawParticles = b; }
         void setFillOrbits(bool b) { fillOrbits = b; }
-        void setdrawOrbitNormals(bool b) { drawOrbitNormals = b; }
-        void setZoom(double zoomPercent) { scaleFactor = zoomPercent; updateGL(); }
+        void setZoom(double zoomPercent) { scaleFactor = zoomPercent; requestRedraw(); }
         void updateOrRecord();
         void saveCurrentImage(int id);
         bool simulationDataLoaded;
@@ -129,18 +171,35 @@ namespace Disp
         //void performIntermediateAction(QTableWidgetItem* a);
         void playbackQueue(QTableWidget* queue);
         void record(QTableWidget* queue);
+        bool record(QTableWidget* queue, QString const& output, int first = 0, int last = -1);
+        bool renderPoster(QString const& path, QSize const& size);
+        void playThrough(QTableWidget* queue);
+        static int recordedFrames(QTableWidget* queue);
+        void recordMovie(QTableWidget* queue);
+        TimelinePlayer& timelinePlayer() { return player; }
+        bool startHeadless(QSize const& size);
         double getXRotation() { return xrotation; }
         double getYRotation() { return yrotation; }
         double getZRotation() { return zrotation; }
         double getZoomScale() { return scaleFactor; }
         int getCurrentFrame() { return currentIndex; }
+        bool getFullOrbit() const { return drawFullOrbit; }
+        bool getFillOrbits() const { return fillOrbits; }
+        CameraState cameraState() const;
+        void showState(CameraState const& state);
         int getSimulationSize() { return simulationSize; }
         void updateEclipticCache(StaticDisplayOrbits const& eco);
         void updateEquatorialCache(StaticDisplayOrbits const& eqo);
         void updateSimulationCache(OrbitData const& d);
 
     public slots:
+        /*! @brief Asks for a redraw, which the scheduler coalesces with the other requests of the same display refresh.
+
+            Use this for interactive changes; updateGL() still redraws right away.
+        */
+        void requestRedraw() { scheduler.requestFrame(); }
         void setCurrentIndex(int index);
+        void timeScrubbed();
         void setXRot(double deg);
         void setYRot(double deg);
         void setZRot(double deg);
@@ -149,6 +208,12 @@ namespace Disp
         void zoom();
         void simulate();
         void advanceTimeIndex();
+        void showTimelineFrame(int frame);
+#ifdef OGRE_CORE_PROFILE
+        /*! @brief Repaints right away, like QGLWidget::updateGL(), which QOpenGLWidget does not have.
+        */
+        void updateGL() { repaint(); }
+#endif
 
     protected:
         void initializeGL();
@@ -159,20 +224,57 @@ namespace Disp
 
     private:
         enum Display { Pixmap, OpenGL };
-        void performAction(Action a);
-        void rotate(double x, double y, double z, int t);
-        void zoom(double a, double t);
-        void simulate(int a, int t);
-        void doNothing(int t);
-        void initialize(double x, double y, double z, double sc, int fr);
+
+        void makeRenderContextCurrent();
+        QSize renderSize() const;
+        bool createRecordTarget(QSize const& size);
+        QOpenGLFramebufferObject* renderToTarget();
+        void setTileTransform(QRect const& rect, QSize const& size);
+        void releaseRecordTarget();
+        std::vector<RecordingManifest::Segment> recordingSegments(QTableWidget* queue, QSize const& size) const;
+
+        /*! @brief One viewport of the widget: where it is (in widget pixels, from the top left) and how its camera is rotated.
+
+            The free view uses the interactive rotations (xrotation, yrotation, zrotation) instead of its own.
+        */
+        struct View {
+            QRect rect;
+            double xrot, yrot, zrot;
+            QString name;
+            bool free;
+        };
+
+        void renderTimeline(Timeline const& timeline);
+        void playAction(Action const& act);
         void prepfs();
+        double orbitScaleFactor() const;
+        QMatrix4x4 viewProjection() const;
+        QMatrix4x4 worldProjection() const;
+        Point3d focusPosition() const;
+        std::vector<GLfloat> centralBody() const;
+        std::vector<View> layoutViews() const;
+        QSize viewSize() const;
+        QByteArray frameKey() const;
+        void drawView(PreparedFrame const* frame);
+        Point3d equatorialToReference(Point3d const& p) const;
+        void buildStaticLayer(StaticOrbitLayer& layer, StaticDisplayOrbits const& orbits, bool equatorial);
+        void drawAxes();
         void drawTrail();
-        void drawParticle();
+        void updateColormap();
+        void drawParticle(PreparedFrame const& frame);
+        int estimateVisibleParticles() const;
+        bool useDensity();
+        void drawDensity();
+        void updateExposure(PreparedFrame const& frame, View const& view);
+        void cullOrbits(PreparedFrame const& frame);
         void drawOrbit();
-        void drawOrbitalNormal();
+        void drawOrbitalPlanes();
+        void drawGlyphs(PreparedFrame const& frame);
+        void drawLabels();
         template<Display> void drawStats();
         template<Display> void drawLoading();
         template<Display> void drawTime();
+        QString timeLabel() const;
         //void makeMovie(QString moviePath);
 
         // These functoins are meant to allow generalization of overlay painting
@@ -181,34 +283,66 @@ namespace Disp
         template<Display> void drawText(QString str, int topLeftX, int topLeftY, QFontMetrics* fm);
 
         OrbitData orbitData;
-        std::vector<Point3d> normals;
-        double normalsScalar;
         double cosfs[360];
         double sinfs[360];
         int currentIndex;
         int simulationSize;
         StaticDisplayOrbits equatorialOrbits;
         StaticDisplayOrbits eclipticOrbits;
+        StaticOrbitLayer equatorialLayer;
+        StaticOrbitLayer eclipticLayer;
         double scaleFactor;
         Point3d minimum, maximum; //smallest and largest x, y, z, respectively
         double xrotation, yrotation, zrotation;
+        Point3d origin;     // world position the prepared vertices and viewProjection() are relative to (see focusPosition())
+        View activeView;    // the view being drawn by paintGL(), or the free view outside of it
         QPoint lastPos;
-        Sphere centralBody;
         QPainter* currentPainter;
+        TextRenderer text;
+        LineRenderer lines;
+        DensityRenderer density;
+        ParticleRenderer particles;
+        Colormap colormap;
+        OrbitalPlaneRenderer planes;
+        GlyphRenderer arrows;
+        std::vector<GLuint> visibleRings;    // indices into the uploaded rings (see LineRenderer::appendIndices())
+        std::vector<GLuint> visiblePlanes;
+        bool allRingsVisible;
+        bool allPlanesVisible;
+        bool orbitsCollapsed;
+        double attributeMin[ColorAttributeCount];
+        double attributeMax[ColorAttributeCount];
+        QColor textColor;
         GLfloat coordLength;
         Point3d zEq;
         Point3d xEq;
         double obl;
         RotationAngles eqRotAngles;
+        ViewFrustum frustum;
+        QOpenGLVertexArrayObject vertexArray;
+        FrameScheduler scheduler;
         bool loading;
         bool recording;
-        QDir tmpPNGFolder;
+        FrameRecorder recorder;                 // reads back and saves the frames of record()
+        RecordingManifest manifest;             // frames of the stills record() is saving that are already on disk
+        QScopedPointer<QOpenGLFramebufferObject> recordTarget;     // what record() renders into; only exists while recording
+        QScopedPointer<QOpenGLFramebufferObject> recordResolve;    // single-sampled copy of a multisampled recordTarget
+        QOpenGLContext* offscreenContext;       // set by startHeadless(), which renders without a window
+        QOffscreenSurface* offscreenSurface;
         int pictureNumber;
-        int trailLength;
+        int recordFirst, recordLast;            // range of frames record() saves (recordLast < 0 for all frames from recordFirst on)
+        bool tiling;                            // set while renderPoster() draws its tiles
+        QMatrix4x4 tileTransform;               // maps the tile being drawn to the whole viewport (see renderPoster())
+        FrameCache frameCache;                  // frames drawn recently, keyed by frameKey()
+        bool timeMoved;                         // set by timeScrubbed(); only frames reached that way are kept in frameCache
+        TimelinePlayer player;                  // plays the queue back in real time (see playbackQueue())
+        ParticleTrails trails;
         bool drawFullOrbit;
         bool fillOrbits;
         bool drawParticles;
-        bool drawOrbitNormals;
+        bool densityMode;
+        LongExposure exposure;
+        FramePreparer preparer; // declared last so that it is destroyed, and its job finished, before orbitData
 
     };
 } // namespace Disp
@@ -5,14 +5,17 @@ HEADERS += OrbitalDisplays/Settings.h \
            OrbitalDisplays/MainWindow.h \
            OrbitalDisplays/OrbitalAnimator.h \
            OrbitalDisplays/QueueActionDialog.h \
+           OrbitalDisplays/Timeline.h \
            OrbitalDisplays/OpenSimulationDialog.h
 
 SOURCES += OrbitalDisplays/main.cpp \
+           OrbitalDisplays/Settings.cpp \
            OrbitalDisplays/OrbitalAnimator.cpp \
            OrbitalDisplays/OrbitalAnimationDriver.cpp \
            OrbitalDisplays/MainWindow.cpp \
            OrbitalDisplays/SettingsDialog.cpp \
            OrbitalDisplays/QueueActionDialog.cpp \
            OrbitalDisplays/Queue.cpp \
+           OrbitalDisplays/Timeline.cpp \
            OrbitalDisplays/OpenSimulationDialog.cpp
 
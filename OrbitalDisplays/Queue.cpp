@@ -34,6 +34,10 @@
 */
 
 #include "Queue.h"
+#include <QtCore/QFile>
+#include <QtCore/QTextStream>
+
+static const char* actionNames[] = { "none", "rotate", "zoom", "simulate", "pause", "initialize" }; // indexed by Action::typ
 
 /*! @brief Constructor for the queue.
 
@@ -247,3 +251,151 @@ void Queue::removeAction() {
     removeRow(rowToRemove);
     updateQueue(rowToRemove, rowCount());
 }
+
+/*! @brief Writes the queue as a <queue> element, one <action> child per row.
+
+    Every action carries its full state (span, rotations, zoom factor and frame), so the element can be read back
+    by fromXml() without relying on the syncing done by updateQueue().
+*/
+QDomElement Queue::toXml(QDomDocument& document) const {
+    QDomElement queue = document.createElement("queue");
+    for (int i=0; i < rowCount(); i++) {
+        Action act = item(i, 0)->data(Qt::UserRole).value<Action>();
+        QDomElement action = document.createElement("action");
+        action.setAttribute("type", actionNames[act.typ]);
+        action.setAttribute("span", act.span);
+        action.setAttribute("xrot", act.xrot);
+        action.setAttribute("yrot", act.yrot);
+        action.setAttribute("zrot", act.zrot);
+        action.setAttribute("scale", act.scale);
+        action.setAttribute("frame", act.frame);
+        queue.appendChild(action);
+    }
+    return queue;
+}
+
+/*! @brief Replaces the contents of the queue with the actions of a <queue> element written by toXml().
+
+    The first action has to be an initialize and no other may be; missing attributes default to those of the previous
+    action.  On failure the queue is left untouched and, if error is given, it is set to a description of the problem.
+*/
+bool Queue::fromXml(QDomElement const& element, QString* error) {
+    std::vector<Action> actions;
+    for (QDomElement e = element.firstChildElement("action"); !e.isNull(); e = e.nextSiblingElement("action")) {
+        Action act;
+        act.typ = NO_ACTION;
+        for (int t=ROTATE; t <= INITIALIZE; t++)
+            if (e.attribute("type") == actionNames[t]) act.typ = t;
+        if (act.typ == NO_ACTION || (act.typ == INITIALIZE) != actions.empty()) {
+            if (error) *error = QString("line %1: unexpected action \"%2\" (the queue starts with a single initialize)")
+                    .arg(e.lineNumber()).arg(e.attribute("type"));
+            return false;
+        }
+
+        Action prev = actions.empty() ? Action() : actions.back();
+        if (actions.empty()) {
+            prev.xrot = prev.yrot = prev.zrot = 0;
+            prev.scale = 1;
+            prev.frame = 0;
+        }
+        bool ok = true, all = true;
+        act.span = e.attribute("span", "0").toDouble(&ok);                           all &= ok;
+        act.xrot = e.attribute("xrot", QString::number(prev.xrot)).toDouble(&ok);    all &= ok;
+        act.yrot = e.attribute("yrot", QString::number(prev.yrot)).toDouble(&ok);    all &= ok;
+        act.zrot = e.attribute("zrot", QString::number(prev.zrot)).toDouble(&ok);    all &= ok;
+        act.scale = e.attribute("scale", QString::number(prev.scale)).toDouble(&ok); all &= ok;
+        act.frame = e.attribute("frame", QString::number(prev.frame)).toInt(&ok);    all &= ok;
+        if (!all || act.span < 0 || act.scale <= 0 || act.frame < 0) {
+            if (error) *error = QString("line %1: invalid value in %2 action").arg(e.lineNumber()).arg(e.attribute("type"));
+            return false;
+        }
+        act.dFrame = act.frame - prev.frame;
+        act.dxrot = act.xrot - prev.xrot;
+        act.dyrot = act.yrot - prev.yrot;
+        act.dzrot = act.zrot - prev.zrot;
+        act.queueIndex = int(actions.size());
+        actions.push_back(act);
+    }
+    if (actions.empty()) {
+        if (error) *error = "the queue has no actions";
+        return false;
+    }
+
+    setRowCount(0);
+    for (size_t i=0; i < actions.size(); i++) addActionToQueue(actions[i]);
+    return true;
+}
+
+/*! @brief Saves the queue to an XML file at path.  Returns false if the file cannot be written.
+*/
+bool Queue::save(QString const& path) const {
+    QDomDocument document = newDocument();
+    document.documentElement().appendChild(toXml(document));
+    return writeDocument(document, path);
+}
+
+/*! @brief Returns an empty <ogre> document, for save() and for the files that also hold the data and settings the queue is
+    played with (see Disp::OrbitalAnimationDriver::saveQueue()).
+*/
+QDomDocument Queue::newDocument() {
+    QDomDocument document;
+    document.appendChild(document.createProcessingInstruction("xml", "version=\"1.0\" encoding=\"UTF-8\""));
+    QDomElement root = document.createElement("ogre");
+    root.setAttribute("version", 1);
+    document.appendChild(root);
+    return document;
+}
+
+/*! @brief Writes document to path, in UTF-8.  Returns false if the file cannot be written.
+*/
+bool Queue::writeDocument(QDomDocument const& document, QString const& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return false;
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+    document.save(out, 2);
+    return file.error() == QFile::NoError;
+}
+
+/*! @brief Reads the <ogre> document at path into document.
+
+    On failure, if error is given, it is set to a description of the problem.
+*/
+bool Queue::readDocument(QString const& path, QDomDocument& document, QString* error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = QString("cannot open %1: %2").arg(path, file.errorString());
+        return false;
+    }
+    QString message;
+    int line = 0, column = 0;
+    if (!document.setContent(&file, &message, &line, &column)) {
+        if (error) *error = QString("%1:%2:%3: %4").arg(path).arg(line).arg(column).arg(message);
+        return false;
+    }
+    if (document.documentElement().tagName() != "ogre") {
+        if (error) *error = QString("%1: not an OGRE queue file").arg(path);
+        return false;
+    }
+    return true;
+}
+
+/*! @brief Loads a queue saved by save() (the <queue> element of an <ogre> document; any other elements, such as the data and
+    settings written by Disp::OrbitalAnimationDriver::saveQueue(), are ignored).
+
+    On failure the queue is left untouched and, if error is given, it is set to a description of the problem.
+*/
+bool Queue::load(QString const& path, QString* error) {
+    QDomDocument document;
+    if (!readDocument(path, document, error)) return false;
+    QDomElement queue = document.documentElement().firstChildElement("queue");
+    if (queue.isNull()) {
+        if (error) *error = QString("%1: not an OGRE queue file").arg(path);
+        return false;
+    }
+    if (!fromXml(queue, error)) {
+        if (error) *error = path + ": " + *error;
+        return false;
+    }
+    return true;
+}
@@ -42,6 +42,7 @@
 #include <QMenu>
 #include <QAction>
 #include <QHeaderView>
+#include <QtXml/QDomDocument>
 
 #define NO_ACTION 0
 #define ROTATE 1
@@ -87,6 +88,13 @@ public:
     void addActionToQueue(Action act);
     void updateQueue(int i, int j);
     void syncAction(Action a1, Action& a2);
+    QDomElement toXml(QDomDocument& document) const;
+    bool fromXml(QDomElement const& element, QString* error = 0);
+    bool save(QString const& path) const;
+    bool load(QString const& path, QString* error = 0);
+    static QDomDocument newDocument();
+    static bool writeDocument(QDomDocument const& document, QString const& path);
+    static bool readDocument(QString const& path, QDomDocument& document, QString* error = 0);
 
 public slots:
     void provideContextMenu(QPoint p);
@@ -0,0 +1,221 @@
+/*!
+ @file Settings.cpp
+ @brief Reading and writing the settings of the OrbitalAnimator as XML.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "Settings.h"
+#include "Helpers/Colormap.h"
+#include <QtCore/QStringList>
+
+namespace Disp
+{
+    namespace
+    {
+        /*! @brief Reads the attributes of a <settings> element, remembering whether any of them could not be read.
+        */
+        struct SettingsReader
+        {
+            QDomElement const& element;
+            QString bad;    // name of the first attribute that could not be read
+
+            SettingsReader(QDomElement const& e) : element(e) {}
+
+            void read(QString const& name, bool& value) {
+                if (!element.hasAttribute(name)) return;
+                QString text = element.attribute(name);
+                if (text == "1" || text == "true") value = true;
+                else if (text == "0" || text == "false") value = false;
+                else fail(name);
+            }
+            void read(QString const& name, int& value) {
+                if (!element.hasAttribute(name)) return;
+                bool ok;
+                int v = element.attribute(name).toInt(&ok);
+                if (ok) value = v;
+                else fail(name);
+            }
+            void read(QString const& name, double& value) {
+                if (!element.hasAttribute(name)) return;
+                bool ok;
+                double v = element.attribute(name).toDouble(&ok);
+                if (ok) value = v;
+                else fail(name);
+            }
+            void read(QString const& name, QColor& value) {
+                if (!element.hasAttribute(name)) return;
+                QColor c(element.attribute(name));
+                if (c.isValid()) value = c;
+                else fail(name);
+            }
+            void read(QString const& name, QSize& value) {
+                if (!element.hasAttribute(name)) return;
+                QString text = element.attribute(name);
+                QStringList dims = text.split('x');
+                bool wOk = false, hOk = false;
+                QSize s;
+                if (dims.size() == 2) s = QSize(dims[0].toInt(&wOk), dims[1].toInt(&hOk));
+                if (text.isEmpty()) value = QSize();
+                else if (wOk && hOk && !s.isEmpty()) value = s;
+                else fail(name);
+            }
+            void fail(QString const& name) { if (bad.isEmpty()) bad = name; }
+        };
+    }
+
+    /*! @brief Writes every setting that changes the frames drawn as an attribute of a <settings> element.
+
+        Colors are written as #AARRGGBB, and the recording size as WxH (empty for the size of the display).
+    */
+    QDomElement OrbitalAnimatorSettings::toXml(QDomDocument& document) const
+    {
+        QDomElement e = document.createElement("settings");
+        e.setAttribute("displayOverlays", mDisplayOverlays);
+        e.setAttribute("displayCoords", mDisplayCoords);
+        e.setAttribute("displayMainOrbit", mDisplayMainOrbit);
+        e.setAttribute("displaySpinAxis", mDisplaySpinAxis);
+        e.setAttribute("displayMouseTracking", mDisplayMouseTracking);
+        e.setAttribute("displayCentralBody", mDisplayCentralBody);
+        e.setAttribute("displayFrameNumber", mDisplayFrameNumber);
+        e.setAttribute("displayVecX", mDisplayVecX);
+        e.setAttribute("displayTrails", mDisplayTrails);
+        e.setAttribute("displayLabels", mDisplayLabels);
+        e.setAttribute("displayNormals", mDisplayNormals);
+        e.setAttribute("displayVelocities", mDisplayVelocities);
+        e.setAttribute("longExposure", mLongExposure);
+        e.setAttribute("centralBodyColor", mCentralBodyColor.name(QColor::HexArgb));
+        e.setAttribute("orbitalPlaneColor", mOrbitalPlaneColor.name(QColor::HexArgb));
+        e.setAttribute("orbitColor", mOrbitColor.name(QColor::HexArgb));
+        e.setAttribute("trailColor", mTrailColor.name(QColor::HexArgb));
+        e.setAttribute("labelColor", mLabelColor.name(QColor::HexArgb));
+        e.setAttribute("velocityColor", mVelocityColor.name(QColor::HexArgb));
+        e.setAttribute("lineWidth", mLineWidth);
+        e.setAttribute("densityThreshold", mDensityThreshold);
+        e.setAttribute("densityExposure", mDensityExposure);
+        e.setAttribute("colorAttribute", mColorAttribute);
+        e.setAttribute("colorRangeAuto", mColorRangeAuto);
+        e.setAttribute("colorRangeMin", mColorRangeMin);
+        e.setAttribute("colorRangeMax", mColorRangeMax);
+        e.setAttribute("viewLayout", mViewLayout);
+        e.setAttribute("focusParticle", mFocusParticle);
+        e.setAttribute("recordSize", mRecordSize.isEmpty() ? QString() : QString("%1x%2").arg(mRecordSize.width()).arg(mRecordSize.height()));
+        e.setAttribute("recordSamples", mRecordSamples);
+        return e;
+    }
+
+    /*! @brief Sets the settings from the attributes of a <settings> element written by toXml(), and emits changed() once.
+
+        Missing attributes leave their setting as it is.  If an attribute cannot be read, nothing is changed and, if error is
+        given, it is set to a description of the problem.
+    */
+    bool OrbitalAnimatorSettings::fromXml(QDomElement const& element, QString* error)
+    {
+        OrbitalAnimatorSettings s;
+        s.copy(*this);
+        SettingsReader in(element);
+        in.read("displayOverlays", s.mDisplayOverlays);
+        in.read("displayCoords", s.mDisplayCoords);
+        in.read("displayMainOrbit", s.mDisplayMainOrbit);
+        in.read("displaySpinAxis", s.mDisplaySpinAxis);
+        in.read("displayMouseTracking", s.mDisplayMouseTracking);
+        in.read("displayCentralBody", s.mDisplayCentralBody);
+        in.read("displayFrameNumber", s.mDisplayFrameNumber);
+        in.read("displayVecX", s.mDisplayVecX);
+        in.read("displayTrails", s.mDisplayTrails);
+        in.read("displayLabels", s.mDisplayLabels);
+        in.read("displayNormals", s.mDisplayNormals);
+        in.read("displayVelocities", s.mDisplayVelocities);
+        in.read("longExposure", s.mLongExposure);
+        in.read("centralBodyColor", s.mCentralBodyColor);
+        in.read("orbitalPlaneColor", s.mOrbitalPlaneColor);
+        in.read("orbitColor", s.mOrbitColor);
+        in.read("trailColor", s.mTrailColor);
+        in.read("labelColor", s.mLabelColor);
+        in.read("velocityColor", s.mVelocityColor);
+        in.read("lineWidth", s.mLineWidth);
+        in.read("densityThreshold", s.mDensityThreshold);
+        in.read("densityExposure", s.mDensityExposure);
+        in.read("colorAttribute", s.mColorAttribute);
+        in.read("colorRangeAuto", s.mColorRangeAuto);
+        in.read("colorRangeMin", s.mColorRangeMin);
+        in.read("colorRangeMax", s.mColorRangeMax);
+        in.read("viewLayout", s.mViewLayout);
+        in.read("focusParticle", s.mFocusParticle);
+        in.read("recordSize", s.mRecordSize);
+        in.read("recordSamples", s.mRecordSamples);
+        if (in.bad.isEmpty() && (s.mColorAttribute < 0 || s.mColorAttribute >= ColorAttributeCount)) in.fail("colorAttribute");
+        if (!in.bad.isEmpty()) {
+            if (error) *error = QString("line %1: invalid value of setting \"%2\"").arg(element.lineNumber()).arg(in.bad);
+            return false;
+        }
+        copy(s);
+        changed();
+        return true;
+    }
+
+    /*! @brief Copies the values of every setting of other, without emitting changed().
+    */
+    void OrbitalAnimatorSettings::copy(OrbitalAnimatorSettings const& other)
+    {
+        mDisplayOverlays = other.mDisplayOverlays;
+        mDisplayCoords = other.mDisplayCoords;
+        mDisplayMainOrbit = other.mDisplayMainOrbit;
+        mDisplaySpinAxis = other.mDisplaySpinAxis;
+        mDisplayMouseTracking = other.mDisplayMouseTracking;
+        mDisplayCentralBody = other.mDisplayCentralBody;
+        mDisplayFrameNumber = other.mDisplayFrameNumber;
+        mDisplayVecX = other.mDisplayVecX;
+        mDisplayTrails = other.mDisplayTrails;
+        mDisplayLabels = other.mDisplayLabels;
+        mDisplayNormals = other.mDisplayNormals;
+        mDisplayVelocities = other.mDisplayVelocities;
+        mLongExposure = other.mLongExposure;
+        mCentralBodyColor = other.mCentralBodyColor;
+        mOrbitalPlaneColor = other.mOrbitalPlaneColor;
+        mOrbitColor = other.mOrbitColor;
+        mTrailColor = other.mTrailColor;
+        mLabelColor = other.mLabelColor;
+        mVelocityColor = other.mVelocityColor;
+        mLineWidth = other.mLineWidth;
+        mDensityThreshold = other.mDensityThreshold;
+        mDensityExposure = other.mDensityExposure;
+        mColorAttribute = other.mColorAttribute;
+        mColorRangeAuto = other.mColorRangeAuto;
+        mColorRangeMin = other.mColorRangeMin;
+        mColorRangeMax = other.mColorRangeMax;
+        mViewLayout = other.mViewLayout;
+        mFocusParticle = other.mFocusParticle;
+        mRecordSize = other.mRecordSize;
+        mRecordSamples = other.mRecordSamples;
+        mFrameCacheSize = other.mFrameCacheSize;
+    }
+} // namespace Disp
@@ -40,6 +40,11 @@
 
 #include <QtCore/QObject>
 #include <QtGui/QColor>
+#include <QtCore/QSize>
+#include <QtCore/QByteArray>
+#include <QtCore/QDataStream>
+#include <QtCore/QCryptographicHash>
+#include <QtXml/QDomDocument>
 
 namespace Disp
 {
@@ -47,6 +52,10 @@ namespace Disp
     {
         Q_OBJECT
     public:
+        /*! @brief How the display is split into views: the free view alone, or top, front, side and free views in a 2x2 grid.
+        */
+        enum ViewLayout { SingleView, QuadViews };
+
         OrbitalAnimatorSettings(QObject* parent = 0)
             : QObject(parent)
             , mDisplayOverlays(false)
@@ -57,9 +66,28 @@ namespace Disp
             , mDisplayCentralBody(true)
             , mDisplayFrameNumber(false)
             , mDisplayVecX(true)
+            , mDisplayTrails(false)
+            , mDisplayLabels(false)
+            , mDisplayNormals(false)
+            , mDisplayVelocities(false)
+            , mLongExposure(false)
             , mCentralBodyColor(0x8A, 0x41, 0x17, 0xFF)
             , mOrbitalPlaneColor(0x56, 0xA5, 0xEC, 0x80)
             , mOrbitColor(0x00, 0xFF, 0x00, 0xFF)//0x4A, 0xA0, 0x2C, 0xFF)
+            , mTrailColor(0xCC, 0x66, 0x00, 0xFF)
+            , mLabelColor(0xC0, 0xC0, 0xC0, 0xFF)
+            , mVelocityColor(0xFF, 0xD7, 0x00, 0xFF)
+            , mLineWidth(8.5)
+            , mDensityThreshold(50000)
+            , mDensityExposure(0.25)
+            , mColorAttribute(0)
+            , mColorRangeAuto(true)
+            , mColorRangeMin(0.)
+            , mColorRangeMax(1.)
+            , mViewLayout(SingleView)
+            , mFocusParticle(-1)
+            , mRecordSamples(0)
+            , mFrameCacheSize(0)
         {}
 
         bool displayOverlays() const { return mDisplayOverlays; }
@@ -70,10 +98,47 @@ namespace Disp
         bool displayCentralBody() const { return mDisplayCentralBody; }
         bool displayFrameNumber() const { return mDisplayFrameNumber; }
         bool displayVecX() const { return mDisplayVecX; }
+        bool displayTrails() const { return mDisplayTrails; }
+        bool displayLabels() const { return mDisplayLabels; }
+        bool displayNormals() const { return mDisplayNormals; }
+        bool displayVelocities() const { return mDisplayVelocities; }
+        bool longExposure() const { return mLongExposure; }
 
         QColor centralBodyColor() const { return mCentralBodyColor; }
         QColor orbitalPlaneColor() const { return mOrbitalPlaneColor; }
         QColor orbitColor() const { return mOrbitColor; }
+        QColor trailColor() const { return mTrailColor; }
+        QColor labelColor() const { return mLabelColor; }
+        QColor velocityColor() const { return mVelocityColor; }
+        double lineWidth() const { return mLineWidth; }
+        int densityThreshold() const { return mDensityThreshold; }
+        double densityExposure() const { return mDensityExposure; }
+        int colorAttribute() const { return mColorAttribute; }
+        bool colorRangeAuto() const { return mColorRangeAuto; }
+        double colorRangeMin() const { return mColorRangeMin; }
+        double colorRangeMax() const { return mColorRangeMax; }
+        int viewLayout() const { return mViewLayout; }   // a ViewLayout
+        int focusParticle() const { return mFocusParticle; }
+        QSize recordSize() const { return mRecordSize; }
+        int recordSamples() const { return mRecordSamples; }
+        int frameCacheSize() const { return mFrameCacheSize; }
+        QDomElement toXml(QDomDocument& document) const;
+        bool fromXml(QDomElement const& element, QString* error = 0);
+
+        /*! @brief Returns a hash, in hexadecimal, of every setting that changes the frames drawn, which changes whenever one of
+            them does.
+        */
+        QByteArray hash() const {
+            QByteArray bytes;
+            QDataStream out(&bytes, QIODevice::WriteOnly);
+            out << mDisplayOverlays << mDisplayCoords << mDisplayMainOrbit << mDisplaySpinAxis << mDisplayMouseTracking
+                << mDisplayCentralBody << mDisplayFrameNumber << mDisplayVecX << mDisplayTrails << mDisplayLabels
+                << mDisplayNormals << mDisplayVelocities << mLongExposure
+                << mCentralBodyColor << mOrbitalPlaneColor << mOrbitColor << mTrailColor << mLabelColor << mVelocityColor
+                << mLineWidth << mDensityThreshold << mDensityExposure << mColorAttribute << mColorRangeAuto
+                << mColorRangeMin << mColorRangeMax << mViewLayout << mFocusParticle << mRecordSize << mRecordSamples;
+            return QCryptographicHash::hash(bytes, QCryptographicHash::Sha1).toHex();
+        }
 
     public slots:
         void setDisplayOverlays(bool val) { mDisplayOverlays = val; changed(); }
@@ -84,14 +149,35 @@ namespace Disp
         void setDisplayCentralBody(bool val) { mDisplayCentralBody = val; changed(); }
         void setDisplayFrameNumber(bool val) { mDisplayFrameNumber = val; changed(); }
         void setDisplayVecX(bool val){ mDisplayVecX = val; changed(); }
+        void setDisplayTrails(bool val) { mDisplayTrails = val; changed(); }
+        void setDisplayLabels(bool val) { mDisplayLabels = val; changed(); }
+        void setDisplayNormals(bool val) { mDisplayNormals = val; changed(); }
+        void setDisplayVelocities(bool val) { mDisplayVelocities = val; changed(); }
+        void setLongExposure(bool val) { mLongExposure = val; changed(); }
         void setCentralBodyColor(const QColor& val) { mCentralBodyColor = val; changed(); }
         void setOrbitalPlaneColor(const QColor& val) { mOrbitalPlaneColor = val; changed(); }
         void setOrbitColor(const QColor& val) { mOrbitColor = val; changed(); }
+        void setTrailColor(const QColor& val) { mTrailColor = val; changed(); }
+        void setLabelColor(const QColor& val) { mLabelColor = val; changed(); }
+        void setVelocityColor(const QColor& val) { mVelocityColor = val; changed(); }
+        void setLineWidth(double val) { mLineWidth = val; changed(); }
+        void setDensityThreshold(int val) { mDensityThreshold = val; changed(); }
+        void setDensityExposure(double val) { mDensityExposure = val; changed(); }
+        void setColorAttribute(int val) { mColorAttribute = val; changed(); }
+        void setColorRangeAuto(bool val) { mColorRangeAuto = val; changed(); }
+        void setColorRange(double min, double max) { mColorRangeMin = min; mColorRangeMax = max; mColorRangeAuto = false; changed(); }
+        void setViewLayout(int val) { mViewLayout = val; changed(); }
+        void setFocusParticle(int val) { mFocusParticle = val; changed(); }
+        void setRecordSize(const QSize& val) { mRecordSize = val; changed(); }
+        void setRecordSamples(int val) { mRecordSamples = val; changed(); }
+        void setFrameCacheSize(int val) { mFrameCacheSize = val; changed(); }
 
     signals:
         void changed();
 
     private:
+        void copy(OrbitalAnimatorSettings const& other);
+
         bool mDisplayOverlays;
         bool mDisplayCoords;
         bool mDisplayMainOrbit;
@@ -100,9 +186,29 @@ namespace Disp
         bool mDisplayCentralBody;
         bool mDisplayFrameNumber;
         bool mDisplayVecX;
+        bool mDisplayTrails;
+        bool mDisplayLabels;
+        bool mDisplayNormals;
+        bool mDisplayVelocities;
+        bool mLongExposure;         // if set, the particles of every frame are added up behind the free view (see LongExposure)
         QColor mCentralBodyColor;
         QColor mOrbitalPlaneColor;
         QColor mOrbitColor;
+        QColor mTrailColor;
+        QColor mLabelColor;
+        QColor mVelocityColor;
+        double mLineWidth;  // in pixels, for orbits, trails and axes
+        int mDensityThreshold;      // number of visible particles above which they are drawn as a density
+        double mDensityExposure;    // brightness of the density display, per particle on a pixel
+        int mColorAttribute;        // a ColorAttribute (see Colormap.h)
+        bool mColorRangeAuto;       // if set, the colormap spans the loaded values instead of [mColorRangeMin, mColorRangeMax]
+        double mColorRangeMin;
+        double mColorRangeMax;
+        int mViewLayout;            // a ViewLayout
+        int mFocusParticle;         // ID of the particle the view is centered on, or -1 for the central body
+        QSize mRecordSize;          // size of the recorded frames, or empty for the size of the display
+        int mRecordSamples;         // samples per pixel of the recorded frames, 0 for no multisampling
+        int mFrameCacheSize;        // megabytes of rendered frames kept to be shown again without rendering, 0 for none (see FrameCache)
         int xrot;
         int yrot;
         int zrot;
@@ -257,6 +257,7 @@ namespace Disp
         connect(timeIndex, SIGNAL(valueChanged(int)), this, SLOT(setSliderValue(int)));
         connect(scrollTimeIndex, SIGNAL(valueChanged(int)), this, SIGNAL(setCurrentIndex(int)));
         connect(scrollTimeIndex, SIGNAL(valueChanged(int)), this, SLOT(setBoxValue(int)));
+        connect(scrollTimeIndex, SIGNAL(actionTriggered(int)), this, SIGNAL(timeScrubbed()));   // the user, not setValue()
 /*
         connect(xRotationBox, SIGNAL(valueChanged(double)), this, SIGNAL(setXRot(double)));
         connect(yRotationBox, SIGNAL(valueChanged(double)), this, SIGNAL(setYRot(double)));
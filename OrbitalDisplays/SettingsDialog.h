@@ -115,6 +115,8 @@ namespace Disp
 
         void setCurrentIndex(int);
 
+        void timeScrubbed();
+
         void setXRot(double);
 
         void setYRot(double);
@@ -0,0 +1,230 @@
+/*!
+ @file Timeline.cpp
+ @brief Implementation of Timeline, which evaluates the queue at any frame, and TimelinePlayer, which plays it in real time.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#include "Timeline.h"
+#include "OrbitalAnimator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Disp
+{
+    /*! @brief Keeps rotation angles in the range [-180,180].
+    */
+    double checkRotRange(double rot) {
+        if (rot > 180.) rot -= 360.;
+        if (rot < -180.) rot += 360.;
+        return rot;
+    }
+
+    /*! @brief Checks which direction to rotate is shorter, and returns dtheta.
+     *
+     * Wraps around 180, so rotation angle ranges are [-180,180].
+    */
+    double dThetaRotMin(double theta, double thetaFinal){
+        double theta1 = thetaFinal - theta;
+        double theta2 = (theta1 > 0) ? theta1 - 360. : theta1 + 360.; // rotation in other direction to theta1
+
+        return (std::fabs(theta1) <= std::fabs(theta2)) ? theta1 : theta2;
+    }
+
+    Timeline::Timeline()
+        : total(0)
+    {
+        CameraState none = { 0., 0., 0., 1., 0 };
+        end = none;
+    }
+
+    /*! @brief Lays the actions out one after the other, from start.
+    */
+    Timeline::Timeline(std::vector<Action> const& actions, CameraState const& start)
+        : total(0)
+        , end(start)
+    {
+        for (size_t a = 0; a < actions.size(); ++a) {
+            Segment segment = { actions[a], total, framesOf(actions[a]), end };
+            if (segment.count == 0) continue;
+            segments.push_back(segment);
+            total += segment.count;
+            end = step(segment, segment.count - 1);
+        }
+    }
+
+    /*! @brief Returns the actions of the queue, in order.
+    */
+    std::vector<Action> Timeline::actionsOf(QTableWidget* queue) {
+        std::vector<Action> actions;
+        for (int i=0; i < queue->rowCount(); i++)
+            actions.push_back(queue->item(i, 0)->data(Qt::UserRole).value<Action>());
+        return actions;
+    }
+
+    /*! @brief Returns the number of frames act takes.  A pause's span is in frames, the others' in seconds.
+    */
+    int Timeline::framesOf(Action const& act) {
+        int nFrames = int(act.span*FPS);
+        switch (act.typ) {
+        case ROTATE: return nFrames;
+        case ZOOM: return std::max(nFrames, 1);
+        case SIMULATE: return nFrames;
+        case PAUSE: return int(act.span);
+        case INITIALIZE: return 1;
+        }
+        return 0;
+    }
+
+    /*! @brief Returns the state at frame (clamped to the timeline).
+    */
+    CameraState Timeline::at(int frame) const {
+        if (frame < 0 && !segments.empty()) return step(segments.front(), 0);
+        for (size_t s = 0; s < segments.size(); ++s) {
+            if (frame < segments[s].first + segments[s].count) return step(segments[s], frame - segments[s].first);
+        }
+        return end;
+    }
+
+    /*! @brief Returns the state on frame i of segment.
+    */
+    CameraState Timeline::step(Segment const& segment, int i) {
+        Action const& act = segment.action;
+        CameraState state = segment.start;
+        double t = segment.count > 1 ? double(i) / (segment.count - 1) : 1.;    // reaches the target on the last frame
+        switch (act.typ) {
+        case ROTATE:
+            state.xrot = checkRotRange(state.xrot + t*dThetaRotMin(state.xrot, act.xrot));
+            state.yrot = checkRotRange(state.yrot + t*dThetaRotMin(state.yrot, act.yrot));
+            state.zrot = checkRotRange(state.zrot + t*dThetaRotMin(state.zrot, act.zrot));
+            break;
+        case ZOOM:
+            state.scale = (i == segment.count - 1) ? act.scale : state.scale + t*(act.scale - state.scale);
+            break;
+        case SIMULATE:
+            state.frame = int(floor(state.frame + t*(act.frame - state.frame) + 0.5));
+            break;
+        case INITIALIZE:
+            state.xrot = act.xrot;
+            state.yrot = act.yrot;
+            state.zrot = act.zrot;
+            state.scale = act.scale;
+            state.frame = act.frame;
+            break;
+        }
+        return state;
+    }
+
+    TimelinePlayer::TimelinePlayer(QObject* parent)
+        : QObject(parent)
+        , offset(0)
+        , playing(false)
+        , shown(-1)
+        , dropped(0)
+    {
+        timer.setTimerType(Qt::PreciseTimer);
+        timer.setInterval(int(1000/FPS));
+        connect(&timer, SIGNAL(timeout()), this, SLOT(tick()));
+    }
+
+    /*! @brief Plays timeline from its first frame, which is emitted right away.  Stops whatever was playing.
+    */
+    void TimelinePlayer::play(Timeline const& t) {
+        stop();
+        mTimeline = t;
+        playing = true;
+        offset = 0;
+        shown = -1;
+        dropped = 0;
+        clock.start();
+        timer.start();
+        tick();
+    }
+
+    /*! @brief Returns the frame the clock has reached.
+    */
+    int TimelinePlayer::position() const {
+        qint64 msecs = offset + (clock.isValid() ? clock.elapsed() : 0);
+        return int(msecs * FPS / 1000);
+    }
+
+    /*! @brief Stops the clock, on the frame shown last.
+    */
+    void TimelinePlayer::pause() {
+        if (!playing || !clock.isValid()) return;
+        offset += clock.elapsed();
+        clock.invalidate();
+        timer.stop();
+    }
+
+    /*! @brief Restarts the clock where pause() stopped it.
+    */
+    void TimelinePlayer::resume() {
+        if (!playing || clock.isValid()) return;
+        clock.start();
+        timer.start();
+    }
+
+    /*! @brief Moves the clock to frame, and shows it, whether playing or paused.
+    */
+    void TimelinePlayer::seek(int frame) {
+        if (!playing) return;
+        frame = std::max(0, std::min(frame, mTimeline.frames() - 1));
+        offset = qint64(std::ceil(frame * 1000 / FPS));
+        if (clock.isValid()) clock.start();
+        shown = frame;
+        emit frameReached(frame);
+    }
+
+    /*! @brief Ends the playback, leaving the state on the frame shown last.  Does not emit finished().
+    */
+    void TimelinePlayer::stop() {
+        timer.stop();
+        clock.invalidate();
+        playing = false;
+    }
+
+    /*! @brief Emits the frame the clock has reached, if it is a new one, counting those it went past as dropped.
+    */
+    void TimelinePlayer::tick() {
+        int frame = position();
+        if (frame >= mTimeline.frames()) {
+            if (shown < mTimeline.frames() - 1) emit frameReached(mTimeline.frames() - 1);
+            stop();
+            emit finished();
+            return;
+        }
+        if (frame == shown) return;
+        if (frame > shown + 1) dropped += frame - shown - 1;
+        shown = frame;
+        emit frameReached(frame);
+    }
+} // namespace Disp
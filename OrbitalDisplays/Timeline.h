@@ -0,0 +1,134 @@
+/*!
+ @file Timeline.h
+ @brief Class definitions for Timeline, which evaluates the queue at any frame, and TimelinePlayer, which plays it in real time.
+
+ @section LICENSE
+
+ Copyright (c) 2013 Robert Douglas, Heming Ge, Daniel Tamayo
+ Copyright (c) 2012 Robert Douglas
+
+ This file is part of OGRE.
+
+ OGRE is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ OGRE is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with OGRE.  If not, see <http://www.gnu.org/licenses/>.
+
+ The original code for this project was developed by Robert Douglas.
+ This version is derived from Robert Douglas's
+ repository at https://www.assembla.com/profile/rwdougla revision 29.
+ The copyright notice from the original code is given below:
+
+ Copyright (c) 2012 Robert Douglas
+ Distributed under the accompanying Software License, Version 1.0.
+ (See accompanying file LICENSE_ORIGINAL.txt or copy at
+ https://subversion.assembla.com/svn/rob_douglas_sandbox/trunk/license.txt)
+*/
+
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <vector>
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+#include <QtCore/QElapsedTimer>
+#include "Queue.h"
+
+namespace Disp
+{
+    double checkRotRange(double rot);
+    double dThetaRotMin(double theta, double thetaFinal);
+
+    /*! @brief What the queue sets: the rotations, the zoom and the simulation frame shown.
+    */
+    struct CameraState
+    {
+        double xrot, yrot, zrot, scale;
+        int frame;
+    };
+
+    /*! @brief The state a list of actions sets at each of the frames they take, at FPS frames per second.
+
+        Each action starts from the state the previous one ends in (the first from the state given), and its frames follow
+        from framesOf(): a rotation, a zoom or a simulation moves from that state to its target over its span, in equal steps,
+        reaching the target on its last frame; a pause holds the state for span frames; an initialization sets it in one frame.
+
+        at() takes any frame, in any order, so that a recording can walk the frames one by one and TimelinePlayer can jump to
+        whichever frame the clock has reached.
+    */
+    class Timeline
+    {
+    public:
+        Timeline();
+        Timeline(std::vector<Action> const& actions, CameraState const& start);
+        static std::vector<Action> actionsOf(QTableWidget* queue);
+        static int framesOf(Action const& act);
+        int frames() const { return total; }
+        CameraState at(int frame) const;
+
+    private:
+        struct Segment {
+            Action action;
+            int first, count;
+            CameraState start;
+        };
+
+        static CameraState step(Segment const& segment, int i);
+
+        std::vector<Segment> segments;
+        int total;
+        CameraState end;    // the state after the last frame (the start if there are no frames)
+    };
+
+    /*! @brief Plays a Timeline against the clock, without blocking the event loop.
+
+        A timer ticks FPS times a second, and each tick emits the frame the elapsed time has reached.  When a frame takes
+        longer than that to render, the frames the clock went past are never emitted: playback drops frames rather than
+        slowing down, so that the queue lasts as long as it will in the recording.  pause() stops the clock, resume() restarts
+        it, seek() moves it to any frame, and stop() ends the playback; finished() is emitted after the last frame.
+    */
+    class TimelinePlayer : public QObject
+    {
+        Q_OBJECT
+    public:
+        TimelinePlayer(QObject* parent = 0);
+        void play(Timeline const& timeline);
+        Timeline const& timeline() const { return mTimeline; }
+        bool isPlaying() const { return playing; }
+        bool isPaused() const { return playing && !clock.isValid(); }
+        int position() const;
+        int droppedFrames() const { return dropped; }
+
+    public slots:
+        void pause();
+        void resume();
+        void seek(int frame);
+        void stop();
+
+    signals:
+        void frameReached(int frame);
+        void finished();
+
+    private slots:
+        void tick();
+
+    private:
+        Timeline mTimeline;
+        QTimer timer;
+        QElapsedTimer clock;    // invalid while paused
+        qint64 offset;          // milliseconds played before clock was last started
+        bool playing;
+        int shown;              // the last frame emitted, -1 before the first
+        int dropped;
+    };
+} // namespace Disp
+
+#endif
@@ -39,6 +39,10 @@
 
 #include <QtGui/QApplication>
 #include "OrbitalDisplays/MainWindow.h"
+#include "OrbitalDisplays/OrbitalAnimationDriver.h"
+#include "OrbitalDisplays/Queue.h"
+#include "Helpers/GLProfile.h"
+#include "Helpers/FrameSink.h"
 #include <iostream>
 #include <QtCore/QDebug>
 #include <QCommandLineOption>
@@ -46,9 +50,188 @@
 //#include <QCoreApplication>
 #include <QString>
 #include <QStringList>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QProcess>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+/*! @brief Whether the command line asks for batch mode, checked before the application exists so the platform can be chosen.
+*/
+static bool batchRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+        if (!strcmp(argv[i], "-b") || !strcmp(argv[i], "--batch") || !strncmp(argv[i], "--batch=", 8)) return true;
+    return false;
+}
+
+/*! @brief What the command line asks the batch mode to render.
+*/
+struct BatchOptions
+{
+    QString filename, integrator, type;     // empty filename for the input file saved with the queue
+    QString queue;          // the saved action queue
+    QString output;         // a folder for numbered stills, or a movie file if it has the suffix of one (see VideoSink)
+    QSize size;             // empty for the recording size saved with the queue
+    int samples;            // < 0 for the samples saved with the queue
+    int jobs;               // number of processes to split the frames between
+    int first, last;        // range of frames to render (last < 0 for all frames from first on)
+    QString poster;         // if set, a poster of size of the state the queue ends in is saved there instead
+};
+
+/*! @brief Loads the queue saved in path into queue, printing why it cannot be loaded if it cannot.
+*/
+static bool loadQueue(Queue& queue, QString const& path)
+{
+    QString error;
+    if (queue.load(path, &error)) return true;
+    fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate("main", "Error: %1").arg(error)));
+    return false;
+}
+
+/*! @brief Whether the queue saved in path is recorded as a long exposure, which adds up the frames as they are played and so must
+    be rendered whole, from the first frame, by a single process (see Disp::OrbitalAnimator::record()).
+*/
+static bool recordsLongExposure(QString const& path)
+{
+    QDomDocument document;
+    if (!Queue::readDocument(path, document)) return false;
+    QDomElement element = document.documentElement().firstChildElement("settings");
+    Disp::OrbitalAnimatorSettings settings;
+    return !element.isNull() && settings.fromXml(element) && settings.longExposure();
+}
+
+/*! @brief Renders the frames of the queue in options to its output, without a window.  Returns the exit code.
+
+    The data file is loaded and the queue played back exactly as Record does in the application, through a
+    Disp::OrbitalAnimationDriver that is never shown and an OpenGL context on an offscreen surface.  The settings saved with
+    the queue (see Disp::OrbitalAnimationDriver::saveQueue()) and the camera and orbit display it starts from are applied, and
+    its input file is used unless options names one.
+*/
+static int renderBatch(BatchOptions const& options)
+{
+    Disp::OrbitalAnimationDriver driver;
+    driver.setupUI();
+    Queue queue(0, 7, 0);
+    Disp::SimulationSource source;
+    Disp::QueueStart start;
+    QString error;
+    if (!driver.loadQueue(options.queue, &queue, &source, &error, &start)) {
+        fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate("main", "Error: %1").arg(error)));
+        return 1;
+    }
+    if (options.poster.isEmpty() && options.first > 0 && driver.animatorSettings.longExposure()) {
+        fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate("main", "Error: %1 is recorded as a long exposure, which must start from frame 0").arg(options.queue)));
+        return 1;
+    }
+    if (!options.filename.isEmpty()) {
+        source.filename = options.filename;
+        source.fileType = options.integrator;
+        source.dataType = options.type;
+        source.fullOrbit = true;
+    }
+    if (source.filename.isEmpty()) {
+        fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate("main", "Error: %1 was saved without an input file, give one with -f").arg(options.queue)));
+        return 1;
+    }
+    QString output = options.poster.isEmpty() ? options.output : options.poster;
+    if (!QDir().mkpath(VideoSink::handles(output) || !options.poster.isEmpty() ? QFileInfo(output).absolutePath() : output)) {
+        fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate("main", "Error: cannot create output directory for %1").arg(output)));
+        return 1;
+    }
+
+    QSize size = options.size.isEmpty() ? driver.animatorSettings.recordSize() : options.size;
+    if (size.isEmpty()) size = QSize(1280, 720);
+    driver.animatorSettings.setRecordSize(size);
+    if (options.samples >= 0) driver.animatorSettings.setRecordSamples(options.samples);
+    if (!driver.startHeadless(size)) {
+        fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate("main", "Error: no offscreen OpenGL context (try QT_QPA_PLATFORM=offscreen, or minimalegl with EGL_PLATFORM=surfaceless)")));
+        return 1;
+    }
+    driver.setSimulationData(source.filename, source.fileType, source.dataType, source.fullOrbit);
+    driver.showStart(start);
+    if (!options.poster.isEmpty()) {
+        if (driver.savePoster(options.poster, size, &queue)) return 0;
+        fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate("main", "Error: could not write %1").arg(options.poster)));
+        return 1;
+    }
+    if (!driver.record(&queue, output, options.first, options.last)) {
+        fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate("main", "Error: could not write %1").arg(output)));
+        return 1;
+    }
+    return 0;
+}
+
+/*! @brief Splits the frames of the queue in options (those in options.first to options.last - 1) between options.jobs processes of this program that render them at the same
+    time, each with its own offscreen context.  Returns the exit code.
+
+    The queue is deterministic, so each process can play it through to the start of its range without rendering (see
+    Disp::OrbitalAnimator::record()).  Stills simply land in the same folder with their numbers in the whole recording; a movie is
+    recorded as one part per process (movie.partN.suffix, next to it), which are then joined and removed.
+*/
+static int renderSegments(BatchOptions const& options)
+{
+    Queue queue(0, 7, 0);
+    if (!loadQueue(queue, options.queue)) return 1;
+    if (recordsLongExposure(options.queue)) {
+        fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate("main", "Error: %1 is recorded as a long exposure, which cannot be split between jobs").arg(options.queue)));
+        return 1;
+    }
+    int total = Disp::OrbitalAnimator::recordedFrames(&queue);
+    int begin = options.first, end = options.last < 0 ? total : std::min(options.last, total);
+    if (begin >= end) {
+        fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate("main", "Error: no frames to render in %1:%2, the queue has %3")
+                                           .arg(options.first).arg(options.last < 0 ? QString() : QString::number(options.last)).arg(total)));
+        return 1;
+    }
+    int jobs = std::max(1, std::min(options.jobs, end - begin));
+    bool movie = VideoSink::handles(options.output);
+    QFileInfo info(options.output);
+
+    QStringList parts;
+    std::vector<QProcess*> workers;
+    for (int k = 0; k < jobs; k++) {
+        int first = begin + int(qint64(end - begin) * k / jobs), last = begin + int(qint64(end - begin) * (k + 1) / jobs);
+        QString part = movie ? info.dir().filePath(QString("%1.part%2.%3").arg(info.completeBaseName()).arg(k).arg(info.suffix()))
+                             : options.output;
+        parts << part;
+        QStringList args;
+        if (!options.filename.isEmpty()) args << "-f" << options.filename << "-i" << options.integrator << "-t" << options.type;
+        if (!options.size.isEmpty()) args << "--size" << QString("%1x%2").arg(options.size.width()).arg(options.size.height());
+        if (options.samples >= 0) args << "--samples" << QString::number(options.samples);
+        args << "-b" << options.queue << "-o" << part << "--frames" << QString("%1:%2").arg(first).arg(last);
+        QProcess* worker = new QProcess;
+        worker->setProcessChannelMode(QProcess::ForwardedChannels);
+        worker->start(QCoreApplication::applicationFilePath(), args);
+        workers.push_back(worker);
+    }
+
+    bool rendered = true;
+    for (size_t k = 0; k < workers.size(); k++) {
+        rendered &= workers[k]->waitForFinished(-1) && workers[k]->exitStatus() == QProcess::NormalExit && workers[k]->exitCode() == 0;
+        delete workers[k];
+    }
+    if (rendered && movie) rendered = VideoSink::concatenate(parts, options.output);
+    if (movie)
+        for (int k = 0; k < parts.size(); k++) QFile::remove(parts[k]);
+    if (!rendered) {
+        fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate("main", "Error: could not write %1").arg(options.output)));
+        return 1;
+    }
+    return 0;
+}
 
 int main(int argc, char *argv[])
 {
+#ifdef OGRE_CORE_PROFILE
+    QSurfaceFormat::setDefaultFormat(GLProfile::coreFormat()); // must be set before the application creates any context
+#endif
+    // batch mode renders without a window, so it must not need a display server.  Qt's offscreen platform creates its
+    // contexts through GLX/EGL where available; on display-less nodes set QT_QPA_PLATFORM=minimalegl and
+    // EGL_PLATFORM=surfaceless to render through Mesa (llvmpipe stands in for OSMesa when there is no GPU).
+    if (batchRequested(argc, argv) && qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
     QApplication a(argc, argv);
 
     QCoreApplication::setApplicationName("OGRE");
@@ -67,6 +250,20 @@ int main(int argc, char *argv[])
     parser.addOption(intOption);
     QCommandLineOption typeOption(QStringList() << "t" << "type", QCoreApplication::translate("main", "Format of input file (osc or xyz). Default is osc."), QCoreApplication::translate("main", "type"), "osc");
     parser.addOption(typeOption);
+    QCommandLineOption batchOption(QStringList() << "b" << "batch", QCoreApplication::translate("main", "Render the action queue saved in this file without a window, with the settings saved with it, then exit. Needs -o, and -f if the queue was saved without its input file."), QCoreApplication::translate("main", "queue"));
+    parser.addOption(batchOption);
+    QCommandLineOption outputOption(QStringList() << "o" << "output", QCoreApplication::translate("main", "Where the batch mode writes its frames: a directory (created if needed) for numbered PNGs, or a movie file (.mp4, .mkv, .mov, .y4m, .rgb)."), QCoreApplication::translate("main", "output"));
+    parser.addOption(outputOption);
+    QCommandLineOption sizeOption(QStringList() << "size", QCoreApplication::translate("main", "Size of the frames rendered in batch mode. Default is the recording size saved with the queue, or 1280x720."), QCoreApplication::translate("main", "WxH"));
+    parser.addOption(sizeOption);
+    QCommandLineOption samplesOption(QStringList() << "samples", QCoreApplication::translate("main", "Samples per pixel of the frames rendered in batch mode (0 for no multisampling). Default is the number saved with the queue, or 0."), QCoreApplication::translate("main", "samples"));
+    parser.addOption(samplesOption);
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs", QCoreApplication::translate("main", "Number of processes the batch mode splits the frames between. Default is 1."), QCoreApplication::translate("main", "jobs"), "1");
+    parser.addOption(jobsOption);
+    QCommandLineOption framesOption(QStringList() << "frames", QCoreApplication::translate("main", "Render only frames first to last-1 of the queue in batch mode (last may be left out). Default is all."), QCoreApplication::translate("main", "first:last"), "0:");
+    parser.addOption(framesOption);
+    QCommandLineOption posterOption(QStringList() << "poster", QCoreApplication::translate("main", "Instead of recording, save a poster (PNG or PPM) of --size, which may be as large as 16384x16384 or more, of the state the queue ends in."), QCoreApplication::translate("main", "file"));
+    parser.addOption(posterOption);
 
     parser.process(a);
 
@@ -91,6 +288,39 @@ int main(int argc, char *argv[])
 
     QString filename = parser.value(fileOption);
 
+    if (parser.isSet(batchOption)) {
+        QStringList dims = parser.value(sizeOption).split('x');
+        bool wOk = false, hOk = false;
+        QSize size = dims.size() == 2 ? QSize(dims[0].toInt(&wOk), dims[1].toInt(&hOk)) : QSize();
+        if (parser.isSet(sizeOption) && (!wOk || !hOk || size.isEmpty())) {
+            fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate("main", "Error: size must be given as WxH, e.g. 1280x720")));
+            parser.showHelp(1);
+        }
+        if (!parser.isSet(outputOption) && !parser.isSet(posterOption)) {
+            fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate("main", "Error: batch mode needs an output (-o or --poster)")));
+            parser.showHelp(1);
+        }
+        QStringList range = parser.value(framesOption).split(':');
+        bool firstOk = false, lastOk = range.size() == 2 && range[1].isEmpty();
+        BatchOptions options;
+        options.filename = filename;
+        options.integrator = integrator;
+        options.type = type;
+        options.queue = parser.value(batchOption);
+        options.output = parser.value(outputOption);
+        options.size = parser.isSet(sizeOption) ? size : QSize();
+        options.samples = parser.isSet(samplesOption) ? std::max(0, parser.value(samplesOption).toInt()) : -1;
+        options.jobs = std::max(1, parser.value(jobsOption).toInt());
+        options.poster = parser.value(posterOption);
+        options.first = range.size() == 2 ? range[0].toInt(&firstOk) : 0;
+        options.last = lastOk ? -1 : (range.size() == 2 ? range[1].toInt(&lastOk) : -1);
+        if (!firstOk || !lastOk || options.first < 0) {
+            fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate("main", "Error: frames must be given as first:last, e.g. 0:240")));
+            parser.showHelp(1);
+        }
+        return options.jobs > 1 && options.poster.isEmpty() ? renderSegments(options) : renderBatch(options);
+    }
+
     Disp::MainWindow window(filename, integrator, type);
 
     window.show();
@@ -304,14 +534,15 @@ RobD::MainWindow::openSimulation().
 The queue is simply a QTableWidget. Each QTableWidgetItem represents an Action (struct found in QueueActionDialog.h).
 The data for the action is stored in the item in the first column of each row.
 To extract the data, simply call data(Qt::UserRole) on a QTableWidgetItem in the first column.
-For an example, see OrbitalAnimator::playbackQueue().
+For an example, see Disp::Timeline::actionsOf().
 
 To add a different type of action to the queue, see RobD::MainWindow::setupActionSelector().
 Add another line following the same format, except use the new action name.
 In QueueActionDialog.cpp, another case will have to be added, both in the constructor and QueueActionDialog::setValues().
 Here, the dialog will be defined for the new action (add the appropriate input widgets and store them in appropriate variables in QueueActionDialog::setValues()).
-Finally, modify RobD::OrbitalAnimator::performAction() by adding another case just like in QueueActionDialog.
-This case will define what the OrbitalAnimator should do when the action is performed.
+Finally, modify Disp::Timeline::framesOf() and Disp::Timeline::step() by adding another case just like in QueueActionDialog.
+These cases define how many frames the action takes, and the state it sets on each of them, both when the queue is played
+back and when it is recorded.
 
 @section addclass How do I add a new class?
 